@@ -0,0 +1,44 @@
+# Embeds template files into a header as constexpr string views.
+#
+# Usage:
+#   cmake -DTEMPLATE_DIR=<dir> -DTEMPLATES=<a|b|...> -DOUTPUT=<header> -P embed_templates.cmake
+#
+# Each template is exposed as ft::embedded::<identifier>, where the identifier is its path relative to
+# TEMPLATE_DIR with every non-alphanumeric character replaced by '_'.
+
+cmake_minimum_required(VERSION 3.20)
+
+string(REPLACE "|" ";" templates "${TEMPLATES}")
+
+set(content "// Generated by cmake/embed_templates.cmake, do not edit.\n")
+string(APPEND content "#pragma once\n\n#include <string_view>\n\nnamespace ft\n{\nnamespace embedded\n{\n")
+
+foreach(template IN LISTS templates)
+    string(MAKE_C_IDENTIFIER "${template}" identifier)
+    file(READ "${TEMPLATE_DIR}/${template}" hex HEX)
+    string(LENGTH "${hex}" hex_length)
+    math(EXPR size "${hex_length} / 2")
+
+    string(APPEND content "    inline constexpr std::string_view ${identifier}{\n")
+    if(hex_length EQUAL 0)
+        string(APPEND content "        \"\",\n")
+    endif()
+
+    # 32 bytes per line, every byte as a hex escape
+    set(offset 0)
+    while(offset LESS hex_length)
+        string(SUBSTRING "${hex}" ${offset} 64 chunk)
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" chunk "${chunk}")
+        string(APPEND content "        \"${chunk}\"\n")
+        math(EXPR offset "${offset} + 64")
+    endwhile()
+
+    string(APPEND content "        , ${size}\n    };\n")
+endforeach()
+
+string(APPEND content "} // namespace embedded\n} // namespace ft\n")
+
+# Only touch the header when its content changes, so dependents are not rebuilt needlessly
+file(WRITE "${OUTPUT}.tmp" "${content}")
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,162 @@
+# Builds filetemp with profile-guided and link-time optimization, then benchmarks it against a plain Release build.
+#
+# Usage:
+#   cmake [-DBUILD_DIR=<dir>] [-DGENERATOR=<generator>] [-DRUNS=<n>] [-DLLVM_PROFDATA=<path>] -P cmake/pgo.cmake
+#
+# Steps, all inside BUILD_DIR (build/pgo by default):
+#   1. release/    plain Release build, the baseline
+#   2. optimized/  instrumented build (FT_PGO=GENERATE, FT_LTO=ON)
+#   3. workload/   training run of the instrumented binary, profiles go to profiles/
+#   4. optimized/  rebuilt with the profiles (FT_PGO=USE, FT_LTO=ON), in place so that GCC finds them by object path
+#   5. both binaries run the workload RUNS times, alternately, and the fastest run of each is compared
+#
+# Every run gets its own HOME (LOCALAPPDATA on Windows), so the user's config cache is never touched.
+
+cmake_minimum_required(VERSION 3.23)
+
+get_filename_component(source_dir "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+if(NOT BUILD_DIR)
+    set(BUILD_DIR ${source_dir}/build/pgo)
+endif()
+if(NOT RUNS)
+    set(RUNS 5)
+endif()
+
+set(release_dir ${BUILD_DIR}/release)
+set(optimized_dir ${BUILD_DIR}/optimized)
+set(profile_dir ${BUILD_DIR}/profiles)
+set(work_dir ${BUILD_DIR}/workload)
+
+set(generator_args)
+if(GENERATOR)
+    set(generator_args -G ${GENERATOR})
+endif()
+
+set(exe_suffix)
+if(CMAKE_HOST_WIN32)
+    set(exe_suffix .exe)
+endif()
+
+# The executable lands in <dir>/bin with single and multi-config generators alike
+function(build dir)
+    message(STATUS "Building ${dir}")
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -S ${source_dir} -B ${dir} ${generator_args} -DCMAKE_BUILD_TYPE=Release
+                -DCMAKE_RUNTIME_OUTPUT_DIRECTORY_RELEASE=${dir}/bin ${ARGN}
+        OUTPUT_QUIET
+        COMMAND_ERROR_IS_FATAL ANY)
+    execute_process(COMMAND ${CMAKE_COMMAND} --build ${dir} --config Release OUTPUT_QUIET COMMAND_ERROR_IS_FATAL ANY)
+endfunction()
+
+macro(filetemp)
+    execute_process(COMMAND ${exe} ${ARGN} WORKING_DIRECTORY ${work_dir} OUTPUT_QUIET COMMAND_ERROR_IS_FATAL ANY)
+endmacro()
+
+# Representative use: one-off projects across the option space, config save and load cycles, in-place updates, and
+# batches of projects generated from saved configs, one process per project and from a manifest
+function(workload exe)
+    file(REMOVE_RECURSE ${work_dir})
+    file(MAKE_DIRECTORY ${work_dir}/home)
+    set(ENV{HOME} ${work_dir}/home)
+    set(ENV{LOCALAPPDATA} ${work_dir}/home)
+
+    set(langs CXX C)
+    set(header_modes include pch module)
+    set(build_profiles none dev release)
+    foreach(i RANGE 11)
+        math(EXPR lang "${i} % 2")
+        math(EXPR header_mode "${i} % 3")
+        math(EXPR build_profile "${i} / 4")
+        list(GET langs ${lang} lang)
+        list(GET header_modes ${header_mode} header_mode)
+        list(GET build_profiles ${build_profile} build_profile)
+        math(EXPR minor "20 + ${i}")
+
+        set(extra)
+        if(i GREATER 5)
+            list(APPEND extra --presets --with-bench --with-profiling)
+        endif()
+        filetemp(cmake single/p${i} --project p${i} --version 3.${minor} --main-lang ${lang} --cstd 11 --cxxstd 23
+                 --header-mode ${header_mode} --build-profile ${build_profile} --export-commands --generate-src
+                 ${extra})
+        filetemp(cmake single/p${i} -u -v 3.31 -C 26)
+    endforeach()
+    filetemp(cmake shown -g -s -P)
+
+    filetemp(cmake cfg -S base -v 3.25 -C 20 -H pch -b dev -e -g)
+    filetemp(cmake cfg -S bench -U base -B -i -P)
+    filetemp(cmake cfg -S c -U base -m C -c 17 -H include)
+    set(configs base bench c)
+    foreach(i RANGE 99)
+        math(EXPR config "${i} % 3")
+        list(GET configs ${config} config)
+        filetemp(cmake batch/p${i} -U ${config} -p p${i})
+    endforeach()
+    filetemp(cmake cfg -S base -v 3.28 -C 23 -H module -b release -e -g)
+    foreach(i RANGE 0 99 3)
+        filetemp(cmake batch/p${i} -U base -p p${i})
+    endforeach()
+
+    set(manifest "directory,project,config\n")
+    foreach(i RANGE 999)
+        math(EXPR config "${i} / 100 % 3")
+        list(GET configs ${config} config)
+        string(APPEND manifest "m${i},m${i},${config}\n")
+    endforeach()
+    file(WRITE ${work_dir}/manifest.csv "${manifest}")
+    filetemp(cmake manifest -f manifest.csv -e)
+    filetemp(cmake manifest -f manifest.csv -u -v 3.31)
+
+    filetemp(cmake --help)
+endfunction()
+
+function(elapsed_us exe out_var)
+    string(TIMESTAMP start "%s%f")
+    workload(${exe})
+    string(TIMESTAMP end "%s%f")
+    math(EXPR elapsed "${end} - ${start}")
+    set(${out_var} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+set(release_exe ${release_dir}/bin/filetemp${exe_suffix})
+set(optimized_exe ${optimized_dir}/bin/filetemp${exe_suffix})
+
+build(${release_dir} -DFT_PGO=OFF -DFT_LTO=OFF)
+
+file(REMOVE_RECURSE ${profile_dir})
+build(${optimized_dir} -DFT_PGO=GENERATE -DFT_PGO_DIR=${profile_dir} -DFT_LTO=ON)
+message(STATUS "Training")
+workload(${optimized_exe})
+
+# Clang writes raw profiles that have to be merged, GCC reads its .gcda files directly
+file(GLOB_RECURSE raw_profiles ${profile_dir}/*.profraw)
+if(raw_profiles)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    execute_process(COMMAND ${LLVM_PROFDATA} merge -o ${profile_dir}/default.profdata ${raw_profiles}
+                    COMMAND_ERROR_IS_FATAL ANY)
+endif()
+build(${optimized_dir} -DFT_PGO=USE -DFT_PGO_DIR=${profile_dir} -DFT_LTO=ON)
+
+message(STATUS "Benchmarking, ${RUNS} runs each")
+set(release_best)
+set(optimized_best)
+foreach(run RANGE 1 ${RUNS})
+    elapsed_us(${release_exe} release_us)
+    elapsed_us(${optimized_exe} optimized_us)
+    message(STATUS "  run ${run}: Release ${release_us} us, PGO+LTO ${optimized_us} us")
+    if(NOT release_best OR release_us LESS release_best)
+        set(release_best ${release_us})
+    endif()
+    if(NOT optimized_best OR optimized_us LESS optimized_best)
+        set(optimized_best ${optimized_us})
+    endif()
+endforeach()
+
+math(EXPR speedup "${release_best} * 100 / ${optimized_best}")
+math(EXPR speedup_int "${speedup} / 100")
+math(EXPR speedup_frac "${speedup} % 100")
+if(speedup_frac LESS 10)
+    set(speedup_frac 0${speedup_frac})
+endif()
+message(STATUS "Release: ${release_best} us, PGO+LTO: ${optimized_best} us, speedup ${speedup_int}.${speedup_frac}x")
+message(STATUS "Optimized binary: ${optimized_exe}")
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
 #include <string> // IWYU pragma: export
 #include <string_view>
+#include <utility>
+
+#include "hash.h"
 
 namespace ft
 {
@@ -44,6 +48,7 @@ struct ArgumentStringView
         m_optional = name_prefix_count == 2;
         m_fullName = name_;
         m_shortName = short_name_;
+        m_hash = fnv1a(m_optional ? name_.substr(2) : name_);
     }
 
     // Full name WITH prefix
@@ -64,6 +69,9 @@ struct ArgumentStringView
         }
     }
 
+    // Short name WITH prefix, empty if there is none
+    constexpr std::string_view full_short(this const ArgumentStringView &self) { return self.m_shortName; }
+
     // Short name WITHOUT prefix
     constexpr std::string_view short_name(this const ArgumentStringView &self)
     {
@@ -72,6 +80,9 @@ struct ArgumentStringView
         return ret;
     }
 
+    // Hash of name(), computed at compile time
+    constexpr std::uint64_t hash(this const ArgumentStringView &self) { return self.m_hash; }
+
     constexpr operator std::string_view(this const ArgumentStringView &self) { return self.m_fullName; }
 
     constexpr bool operator==(this const ArgumentStringView &self, const ArgumentStringView &other) noexcept
@@ -82,6 +93,7 @@ struct ArgumentStringView
 private:
     std::string_view m_fullName;
     std::string_view m_shortName;
+    std::uint64_t m_hash;
     bool m_optional;
 };
 
@@ -90,20 +102,41 @@ struct Arg
 {
     ArgumentStringView m_name;
     T m_content{};
+    // Given on the command line or loaded from a config, as opposed to holding its default
+    bool m_used = false;
+    // Given on the command line, configs never override it
+    bool m_given = false;
 
-    Arg(ArgumentStringView name_)
+    Arg(ArgumentStringView name_, T default_ = T{})
         : m_name(name_)
+        , m_content(std::move(default_))
     {
     }
 
     std::string_view full_name(this const Arg &self) { return self.m_name.full(); }
     std::string_view name(this const Arg &self) { return self.m_name.name(); }
     std::string_view short_name(this const Arg &self) { return self.m_name.short_name(); }
+    std::string_view full_short_name(this const Arg &self) { return self.m_name.full_short(); }
+    std::uint64_t hash(this const Arg &self) { return self.m_name.hash(); }
 
     const T &operator*(this const Arg &self) { return self.m_content; }
     T &operator&(this Arg &self) { return self.m_content; }
 
-    void assign(this Arg &self, const T &val) { self.m_content = val; }
+    void assign(this Arg &self, const T &val)
+    {
+        self.m_content = val;
+        self.m_used = true;
+    }
+
+    bool used(this const Arg &self) { return self.m_used; }
+    void mark_used(this Arg &self) { self.m_used = true; }
+
+    bool given(this const Arg &self) { return self.m_given; }
+    void mark_given(this Arg &self)
+    {
+        self.m_given = true;
+        self.m_used = true;
+    }
 };
 
 #define ArgType(arg) decltype(arg.m_content)
@@ -4,18 +4,59 @@
 
 namespace ft
 {
+// Names are usable in constant expressions, e.g. to build the fast parser's lookup table at compile time
+namespace ArgNames
+{
+    constexpr ArgumentStringView CMAKE_WORKDIRECTORY{ "directory" };
+    constexpr ArgumentStringView CMAKE_VERSION{ "--version", "-v" };
+    constexpr ArgumentStringView CMAKE_CSTD{ "--cstd", "-c" };
+    constexpr ArgumentStringView CMAKE_CXXSTD{ "--cxxstd", "-C" };
+    constexpr ArgumentStringView CMAKE_PROJECT{ "--project", "-p" };
+    constexpr ArgumentStringView CMAKE_MAINLANG{ "--main-lang", "-m" };
+    constexpr ArgumentStringView CMAKE_SAVEAS{ "--save-as", "-S" };
+    constexpr ArgumentStringView CMAKE_USECONFIG{ "--use-config", "-U" };
+    constexpr ArgumentStringView CMAKE_EXPORTCMD{ "--export-commands", "-e" };
+    constexpr ArgumentStringView CMAKE_GENSRC{ "--generate-src", "-g" };
+    constexpr ArgumentStringView CMAKE_SHOW{ "--show", "-s" };
+    constexpr ArgumentStringView CMAKE_HEADERMODE{ "--header-mode", "-H" };
+    constexpr ArgumentStringView CMAKE_BUILDPROFILE{ "--build-profile", "-b" };
+    constexpr ArgumentStringView CMAKE_PRESETS{ "--presets", "-P" };
+    constexpr ArgumentStringView CMAKE_WITHBENCH{ "--with-bench", "-B" };
+    constexpr ArgumentStringView CMAKE_WITHPROFILING{ "--with-profiling", "-i" };
+    constexpr ArgumentStringView CMAKE_UPDATE{ "--update", "-u" };
+    constexpr ArgumentStringView CMAKE_METRICS{ "--metrics", "-M" };
+    constexpr ArgumentStringView CMAKE_TRACE{ "--trace", "-T" };
+    constexpr ArgumentStringView CMAKE_MANIFEST{ "--manifest", "-f" };
+    constexpr ArgumentStringView CMAKE_WATCHABLE{ "--watchable", "-W" };
+
+    constexpr ArgumentStringView WATCH_DEBOUNCE{ "--debounce", "-d" };
+} // namespace ArgNames
+
+// Hold their defaults until a parser or a config assigns them
 namespace Args
 {
-    inline Arg CMAKE_WORKDIRECTORY = ArgumentStringView{ "directory" };
-    inline Arg CMAKE_VERSION = ArgumentStringView{ "--version", "-v" };
-    inline Arg<int> CMAKE_CSTD = ArgumentStringView{ "--cstd", "-c" };
-    inline Arg<int> CMAKE_CXXSTD = ArgumentStringView{ "--cxxstd", "-C" };
-    inline Arg CMAKE_PROJECT = ArgumentStringView{ "--project", "-p" };
-    inline Arg CMAKE_MAINLANG = ArgumentStringView{ "--main-lang", "-m" };
-    inline Arg CMAKE_SAVEAS = ArgumentStringView{ "--save-as", "-S" };
-    inline Arg CMAKE_USECONFIG = ArgumentStringView{ "--use-config", "-U" };
-    inline Arg<bool> CMAKE_EXPORTCMD = ArgumentStringView{ "--export-commands", "-e" };
-    inline Arg<bool> CMAKE_GENSRC = ArgumentStringView{ "--generate-src", "-g" };
-    inline Arg<bool> CMAKE_SHOW = ArgumentStringView{ "--show", "-s" };
+    inline Arg<std::string> CMAKE_WORKDIRECTORY{ ArgNames::CMAKE_WORKDIRECTORY, "." };
+    inline Arg<std::string> CMAKE_VERSION{ ArgNames::CMAKE_VERSION, "3.0" };
+    inline Arg<int> CMAKE_CSTD{ ArgNames::CMAKE_CSTD, 99 };
+    inline Arg<int> CMAKE_CXXSTD{ ArgNames::CMAKE_CXXSTD, 20 };
+    inline Arg<std::string> CMAKE_PROJECT{ ArgNames::CMAKE_PROJECT, "foo" };
+    inline Arg<std::string> CMAKE_MAINLANG{ ArgNames::CMAKE_MAINLANG, "CXX" };
+    inline Arg<std::string> CMAKE_SAVEAS{ ArgNames::CMAKE_SAVEAS };
+    inline Arg<std::string> CMAKE_USECONFIG{ ArgNames::CMAKE_USECONFIG };
+    inline Arg<bool> CMAKE_EXPORTCMD{ ArgNames::CMAKE_EXPORTCMD };
+    inline Arg<bool> CMAKE_GENSRC{ ArgNames::CMAKE_GENSRC };
+    inline Arg<bool> CMAKE_SHOW{ ArgNames::CMAKE_SHOW };
+    inline Arg<std::string> CMAKE_HEADERMODE{ ArgNames::CMAKE_HEADERMODE, "include" };
+    inline Arg<std::string> CMAKE_BUILDPROFILE{ ArgNames::CMAKE_BUILDPROFILE, "none" };
+    inline Arg<bool> CMAKE_PRESETS{ ArgNames::CMAKE_PRESETS };
+    inline Arg<bool> CMAKE_WITHBENCH{ ArgNames::CMAKE_WITHBENCH };
+    inline Arg<bool> CMAKE_WITHPROFILING{ ArgNames::CMAKE_WITHPROFILING };
+    inline Arg<bool> CMAKE_UPDATE{ ArgNames::CMAKE_UPDATE };
+    inline Arg<std::string> CMAKE_METRICS{ ArgNames::CMAKE_METRICS };
+    inline Arg<std::string> CMAKE_TRACE{ ArgNames::CMAKE_TRACE };
+    inline Arg<std::string> CMAKE_MANIFEST{ ArgNames::CMAKE_MANIFEST };
+    inline Arg<bool> CMAKE_WATCHABLE{ ArgNames::CMAKE_WATCHABLE };
+
+    inline Arg<int> WATCH_DEBOUNCE{ ArgNames::WATCH_DEBOUNCE, 200 };
 } // namespace Args
 } // namespace ft
\ No newline at end of file
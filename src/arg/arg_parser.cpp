@@ -0,0 +1,274 @@
+#include "arg_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <variant>
+
+#include "arg_def.h"
+#include "hash.h"
+
+namespace ft
+{
+namespace
+{
+    using ArgRef = std::variant<Arg<std::string> *, Arg<int> *, Arg<bool> *>;
+
+    constexpr std::array<std::string_view, 3> header_modes{ "include", "pch", "module" };
+    constexpr std::array<std::string_view, 3> build_profiles{ "none", "dev", "release" };
+
+    struct Option
+    {
+        ArgumentStringView name;
+        ArgRef arg;
+        // Empty if any value is accepted
+        std::span<const std::string_view> choices{};
+    };
+
+// Arg overloads operator& to hand its storage to argparse
+#define FT_OPTION(id, ...) Option{ ArgNames::id, std::addressof(Args::id) __VA_OPT__(, ) __VA_ARGS__ }
+
+    // Long and short names of every option, placed so that each key lands in a slot of its own
+    template <std::size_t N>
+    class OptionTable
+    {
+    public:
+        // At most a quarter full, so that a collision-free seed is found within a few tries
+        static constexpr std::size_t capacity = std::bit_ceil(N * 2 * 4);
+
+        consteval OptionTable(std::array<Option, N> options)
+            : m_options(options)
+        {
+            while (!place_keys())
+            {
+                ++m_seed;
+            }
+        }
+
+        constexpr const Option *find(this const OptionTable &self, std::string_view key)
+        {
+            std::size_t slot = self.slot_of(key);
+            return self.m_keys[slot] == key ? &self.m_options[self.m_indices[slot]] : nullptr;
+        }
+
+    private:
+        constexpr std::size_t slot_of(this const OptionTable &self, std::string_view key)
+        {
+            std::uint64_t mixed = (fnv1a(key) ^ self.m_seed) * 0x9e3779b97f4a7c15ull;
+            return static_cast<std::size_t>(mixed >> (64 - std::countr_zero(capacity)));
+        }
+
+        consteval bool place_keys()
+        {
+            m_keys = {};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                auto name = m_options[i].name;
+                for (std::string_view key : { name.full(), name.full_short() })
+                {
+                    if (key.empty())
+                    {
+                        continue;
+                    }
+
+                    std::size_t slot = slot_of(key);
+                    if (!m_keys[slot].empty())
+                    {
+                        return false;
+                    }
+                    m_keys[slot] = key;
+                    m_indices[slot] = static_cast<std::uint8_t>(i);
+                }
+            }
+            return true;
+        }
+
+    private:
+        std::array<Option, N> m_options;
+        std::uint64_t m_seed = 0;
+        std::array<std::string_view, capacity> m_keys{};
+        std::array<std::uint8_t, capacity> m_indices{};
+    };
+
+    constexpr OptionTable cmake_options{ std::array{
+        FT_OPTION(CMAKE_VERSION),
+        FT_OPTION(CMAKE_CSTD),
+        FT_OPTION(CMAKE_CXXSTD),
+        FT_OPTION(CMAKE_PROJECT),
+        FT_OPTION(CMAKE_MAINLANG),
+        FT_OPTION(CMAKE_SAVEAS),
+        FT_OPTION(CMAKE_USECONFIG),
+        FT_OPTION(CMAKE_EXPORTCMD),
+        FT_OPTION(CMAKE_GENSRC),
+        FT_OPTION(CMAKE_SHOW),
+        FT_OPTION(CMAKE_HEADERMODE, header_modes),
+        FT_OPTION(CMAKE_BUILDPROFILE, build_profiles),
+        FT_OPTION(CMAKE_PRESETS),
+        FT_OPTION(CMAKE_WITHBENCH),
+        FT_OPTION(CMAKE_WITHPROFILING),
+        FT_OPTION(CMAKE_UPDATE),
+        FT_OPTION(CMAKE_METRICS),
+        FT_OPTION(CMAKE_TRACE),
+        FT_OPTION(CMAKE_MANIFEST),
+        FT_OPTION(CMAKE_WATCHABLE),
+    } };
+
+    constexpr OptionTable watch_options{ std::array{
+        FT_OPTION(WATCH_DEBOUNCE),
+    } };
+
+#undef FT_OPTION
+
+    static_assert(cmake_options.find("--header-mode") && cmake_options.find("-H"));
+    static_assert(watch_options.find("--debounce") && watch_options.find("-d"));
+
+    std::optional<int> parse_int(std::string_view text)
+    {
+        int value = 0;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc{} || ptr != text.data() + text.size())
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    struct Assignment
+    {
+        const Option *option;
+        std::string_view value;
+    };
+
+    template <std::size_t N>
+    bool parse_options(const OptionTable<N> &table, std::span<const char *const> tokens, Arg<std::string> *positional)
+    {
+        // Everything is validated before the first assignment, so that argparse starts from untouched Args
+        std::array<Assignment, 64> assignments;
+        std::size_t count = 0;
+        std::optional<std::string_view> positional_value;
+
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+        {
+            std::string_view token = tokens[i];
+            if (count == assignments.size())
+            {
+                return false;
+            }
+
+            if (token.size() < 2 || token[0] != '-')
+            {
+                if (!positional || positional_value)
+                {
+                    return false;
+                }
+                positional_value = token;
+                continue;
+            }
+
+            std::optional<std::string_view> inline_value;
+            if (auto eq = token.find('='); token.starts_with("--") && eq != std::string_view::npos)
+            {
+                inline_value = token.substr(eq + 1);
+                token = token.substr(0, eq);
+            }
+
+            const Option *option = table.find(token);
+            if (!option)
+            {
+                return false;
+            }
+
+            if (std::holds_alternative<Arg<bool> *>(option->arg))
+            {
+                if (inline_value)
+                {
+                    return false;
+                }
+                assignments[count++] = { option, {} };
+                continue;
+            }
+
+            // Values looking like options are left to argparse, which knows whether they are
+            std::string_view value;
+            if (inline_value)
+            {
+                value = *inline_value;
+            }
+            else if (i + 1 < tokens.size() && tokens[i + 1][0] != '-')
+            {
+                value = tokens[++i];
+            }
+            else
+            {
+                return false;
+            }
+
+            if (!option->choices.empty() && std::ranges::find(option->choices, value) == option->choices.end())
+            {
+                return false;
+            }
+            if (std::holds_alternative<Arg<int> *>(option->arg) && !parse_int(value))
+            {
+                return false;
+            }
+            assignments[count++] = { option, value };
+        }
+
+        for (auto &&[option, value] : std::span{ assignments }.first(count))
+        {
+            std::visit(
+                [&]<typename T>(Arg<T> *arg)
+                {
+                    if constexpr (std::same_as<T, bool>)
+                    {
+                        arg->assign(true);
+                    }
+                    else if constexpr (std::same_as<T, int>)
+                    {
+                        arg->assign(*parse_int(value));
+                    }
+                    else
+                    {
+                        arg->assign(std::string{ value });
+                    }
+                    arg->mark_given();
+                },
+                option->arg);
+        }
+        if (positional && positional_value)
+        {
+            positional->assign(std::string{ *positional_value });
+            positional->mark_given();
+        }
+        return true;
+    }
+} // namespace
+
+std::optional<Subcommand> fast_parse(int argc, const char *const *argv)
+{
+    if (argc < 2)
+    {
+        return std::nullopt;
+    }
+
+    std::string_view command = argv[1];
+    std::span<const char *const> tokens{ argv + 2, static_cast<std::size_t>(argc - 2) };
+    if (command == "cmake" && parse_options(cmake_options, tokens, std::addressof(Args::CMAKE_WORKDIRECTORY)))
+    {
+        return Subcommand::cmake;
+    }
+    if (command == "watch" && parse_options(watch_options, tokens, nullptr))
+    {
+        return Subcommand::watch;
+    }
+    return std::nullopt;
+}
+} // namespace ft
\ No newline at end of file
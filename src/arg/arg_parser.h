@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace ft
+{
+enum class Subcommand : std::uint8_t
+{
+    none,
+    cmake,
+    watch
+};
+
+// Parses the command lines of the cmake and watch subcommands straight into Args, without building argparse
+// parsers. Options are looked up in a perfect hash table generated at compile time from ArgNames. Anything it
+// does not fully understand, including help requests and malformed input, is left to argparse by returning
+// nullopt, Args are then untouched
+std::optional<Subcommand> fast_parse(int argc, const char *const *argv);
+} // namespace ft
\ No newline at end of file
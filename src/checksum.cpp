@@ -0,0 +1,147 @@
+#include "checksum.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FT_CRC32C_X86
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FT_TARGET_SSE42
+#else
+#define FT_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define FT_CRC32C_ARM
+#include <arm_acle.h>
+#endif
+
+namespace ft
+{
+namespace detail
+{
+    namespace
+    {
+        using Crc32cTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+        // Slicing-by-8 tables for the reflected Castagnoli polynomial
+        constexpr Crc32cTables make_crc32c_tables()
+        {
+            Crc32cTables tables{};
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1u)));
+                }
+                tables[0][i] = crc;
+            }
+            for (std::size_t t = 1; t < tables.size(); ++t)
+            {
+                for (std::uint32_t i = 0; i < 256; ++i)
+                {
+                    tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xffu];
+                }
+            }
+            return tables;
+        }
+
+        constexpr Crc32cTables crc32c_tables = make_crc32c_tables();
+
+        std::uint32_t crc32c_software(std::uint32_t crc, const std::byte *data, std::size_t size)
+        {
+            const auto &t = crc32c_tables;
+            while (size >= 8)
+            {
+                std::uint32_t lo =
+                    crc ^ (static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+                           static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24);
+                std::uint32_t hi = static_cast<std::uint32_t>(data[4]) | static_cast<std::uint32_t>(data[5]) << 8 |
+                                   static_cast<std::uint32_t>(data[6]) << 16 |
+                                   static_cast<std::uint32_t>(data[7]) << 24;
+                crc = t[7][lo & 0xffu] ^ t[6][(lo >> 8) & 0xffu] ^ t[5][(lo >> 16) & 0xffu] ^ t[4][lo >> 24] ^
+                      t[3][hi & 0xffu] ^ t[2][(hi >> 8) & 0xffu] ^ t[1][(hi >> 16) & 0xffu] ^ t[0][hi >> 24];
+                data += 8;
+                size -= 8;
+            }
+            while (size-- != 0)
+            {
+                crc = (crc >> 8) ^ t[0][(crc ^ static_cast<std::uint32_t>(*data++)) & 0xffu];
+            }
+            return crc;
+        }
+
+#ifdef FT_CRC32C_X86
+        FT_TARGET_SSE42 std::uint32_t crc32c_sse42(std::uint32_t crc, const std::byte *data, std::size_t size)
+        {
+            std::uint64_t crc64 = crc;
+            while (size >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, data, 8);
+                crc64 = _mm_crc32_u64(crc64, word);
+                data += 8;
+                size -= 8;
+            }
+            crc = static_cast<std::uint32_t>(crc64);
+            while (size-- != 0)
+            {
+                crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*data++));
+            }
+            return crc;
+        }
+
+        bool cpu_has_sse42()
+        {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+#else
+            return __builtin_cpu_supports("sse4.2");
+#endif
+        }
+#endif
+
+#ifdef FT_CRC32C_ARM
+        std::uint32_t crc32c_arm(std::uint32_t crc, const std::byte *data, std::size_t size)
+        {
+            while (size >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, data, 8);
+                crc = __crc32cd(crc, word);
+                data += 8;
+                size -= 8;
+            }
+            while (size-- != 0)
+            {
+                crc = __crc32cb(crc, static_cast<std::uint8_t>(*data++));
+            }
+            return crc;
+        }
+#endif
+
+        using Crc32cImpl = std::uint32_t (*)(std::uint32_t, const std::byte *, std::size_t);
+
+        Crc32cImpl select_crc32c()
+        {
+#if defined(FT_CRC32C_X86)
+            return cpu_has_sse42() ? crc32c_sse42 : crc32c_software;
+#elif defined(FT_CRC32C_ARM)
+            return crc32c_arm;
+#else
+            return crc32c_software;
+#endif
+        }
+    } // namespace
+
+    std::uint32_t crc32c_update(std::uint32_t state, std::span<const std::byte> bytes)
+    {
+        static const Crc32cImpl impl = select_crc32c();
+        return impl(state, bytes.data(), bytes.size());
+    }
+} // namespace detail
+} // namespace ft
\ No newline at end of file
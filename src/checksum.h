@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace ft
+{
+namespace detail
+{
+    // Raw CRC-32C register update, without the initial and final inversion
+    std::uint32_t crc32c_update(std::uint32_t state, std::span<const std::byte> bytes);
+} // namespace detail
+
+// Streaming CRC-32C (Castagnoli), using the SSE4.2 or ARMv8 CRC instructions when the CPU has them
+class Crc32c
+{
+public:
+    void update(this Crc32c &self, std::span<const std::byte> bytes)
+    {
+        self.m_state = detail::crc32c_update(self.m_state, bytes);
+    }
+
+    std::uint32_t value(this const Crc32c &self) { return ~self.m_state; }
+
+private:
+    std::uint32_t m_state = 0xffffffffu;
+};
+
+inline std::uint32_t crc32c(std::span<const std::byte> bytes)
+{
+    Crc32c crc;
+    crc.update(bytes);
+    return crc.value();
+}
+} // namespace ft
\ No newline at end of file
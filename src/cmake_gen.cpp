@@ -3,184 +3,1329 @@
 #pragma warning(disable : 4996)
 #include "arg/args.h"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
 #include <exception>
 #include <filesystem>
 #include <format>
-
+#include <optional>
 #include <sstream>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include <yaml-cpp/yaml.h>
 
-#include "argparse/argparse.hpp"
+#include "checksum.h"
+#include "cmake_lexer.h"
+#include "dir_materializer.h"
 #include "file_io.hpp"
 #include "cmake_gen.h"
+#include "file_lock.h"
+#include "file_watcher.h"
+#include "key_table.h"
 #include "log.hpp"
+#include "manifest.h"
+#include "mapped_file.h"
+#include "metrics.h"
+#include "partial_template.h"
+#include "spsc_queue.h"
+#include "templates.h"
+#include "trace.h"
 
 using namespace ft;
 
-constexpr std::string_view c_fileName = "main.c";
-constexpr std::string_view cxx_fileName = "main.cpp";
+constexpr std::string_view cmake_template = R"(cmake_minimum_required(VERSION {0})
+
+set(CMAKE_C_STANDARD {1})
+set(CMAKE_CXX_STANDARD {2})
+{5}{6}
+project({3})
+{8}
+add_executable({3})
+target_sources({3} PRIVATE src/{4})
+target_include_directories({3} PRIVATE src){7}{10}{9}{11})";
+
+constexpr std::string_view bench_subdirectory = R"(
+
+add_subdirectory(bench))";
+
+// The pgo-train test preset of CMakePresets.json turns PGO_TRAINING on for the instrumented build
+constexpr std::string_view pgo_training_block = R"(
+
+set(PGO_TRAINING_ARGS "" CACHE STRING "Arguments of the PGO training run, a representative workload")
+if(PGO_TRAINING)
+    enable_testing()
+    separate_arguments(PGO_TRAINING_ARGS_LIST NATIVE_COMMAND "${PGO_TRAINING_ARGS}")
+    add_test(NAME pgo-train COMMAND ${PROJECT_NAME} ${PGO_TRAINING_ARGS_LIST})
+endif())";
+
+// Everything is behind ENABLE_PROFILING, so the default build is unchanged
+constexpr std::string_view profiling_block = R"(
+
+option(ENABLE_PROFILING "Build with profiling zones, frame pointers and debug info" OFF)
+option(ENABLE_TRACY "Send profiling zones to Tracy, requires ENABLE_PROFILING" OFF)
+if(ENABLE_PROFILING)
+    target_compile_definitions(${PROJECT_NAME} PRIVATE ENABLE_PROFILING)
+    if(MSVC)
+        target_compile_options(${PROJECT_NAME} PRIVATE /Zi /Oy-)
+        target_link_options(${PROJECT_NAME} PRIVATE /DEBUG /PROFILE)
+    else()
+        target_compile_options(${PROJECT_NAME} PRIVATE -g -fno-omit-frame-pointer)
+    endif()
+
+    if(ENABLE_TRACY)
+        include(FetchContent)
+        FetchContent_Declare(
+            tracy
+            GIT_REPOSITORY https://github.com/wolfpld/tracy.git
+            GIT_TAG v0.11.1
+            GIT_SHALLOW TRUE)
+        FetchContent_MakeAvailable(tracy)
+        target_link_libraries(${PROJECT_NAME} PRIVATE TracyClient)
+        target_compile_definitions(${PROJECT_NAME} PRIVATE PROFILE_WITH_TRACY)
+    endif()
+endif())";
+
+// FetchContent_MakeAvailable needs CMake 3.14
+constexpr std::string_view fetch_content_min_version = "3.14";
 
-constexpr std::string_view c_example = R"(#include <stdio.h>
-int main()
+constexpr std::string_view pch_template = R"(
+
+target_precompile_headers(${{PROJECT_NAME}} PRIVATE {0}))";
+
+// The gate has to be set before project(), and every CMake release expects its own value
+constexpr std::string_view import_std_gate = R"(
+if(CMAKE_VERSION VERSION_GREATER_EQUAL 4.1)
+    set(CMAKE_EXPERIMENTAL_CXX_IMPORT_STD "d0edc3af-4c50-42ea-a356-e2862fe7a444")
+elseif(CMAKE_VERSION VERSION_GREATER_EQUAL 4.0)
+    set(CMAKE_EXPERIMENTAL_CXX_IMPORT_STD "a9e1cf81-9932-4810-974b-6eccaf14e457")
+elseif(CMAKE_VERSION VERSION_GREATER_EQUAL 3.30)
+    set(CMAKE_EXPERIMENTAL_CXX_IMPORT_STD "0e5b6991-d74f-4b3d-a41c-cf096e0b2508")
+endif()
+)";
+
+constexpr std::string_view import_std_template = R"(
+
+if("${{CMAKE_CXX_STANDARD}}" IN_LIST CMAKE_CXX_COMPILER_IMPORT_STD)
+    set_target_properties(${{PROJECT_NAME}} PROPERTIES CXX_MODULE_STD ON CXX_SCAN_FOR_MODULES ON)
+    target_compile_definitions(${{PROJECT_NAME}} PRIVATE USE_IMPORT_STD)
+else()
+    target_precompile_headers(${{PROJECT_NAME}} PRIVATE {0})
+endif())";
+
+// target_precompile_headers needs CMake 3.16
+constexpr std::string_view pch_min_version = "3.16";
+
+// The profile blocks go between project() and add_executable(), so plain variables reach the target. Each
+// setting is skipped when the user already defined it, e.g. with -D on the command line
+constexpr std::string_view unity_build_block = R"(
+if(NOT DEFINED CMAKE_UNITY_BUILD)
+    set(CMAKE_UNITY_BUILD ON)
+endif()
+)";
+
+constexpr std::string_view launcher_block = R"(
+find_program(COMPILER_LAUNCHER NAMES ccache sccache)
+if(COMPILER_LAUNCHER AND NOT DEFINED CMAKE_{0}_COMPILER_LAUNCHER)
+    set(CMAKE_C_COMPILER_LAUNCHER ${{COMPILER_LAUNCHER}})
+    set(CMAKE_CXX_COMPILER_LAUNCHER ${{COMPILER_LAUNCHER}})
+endif()
+)";
+
+constexpr std::string_view fast_linker_block = R"(
+include(CheckLinkerFlag)
+if(NOT DEFINED CMAKE_LINKER_TYPE)
+    foreach(linker mold lld)
+        check_linker_flag({0} -fuse-ld=${{linker}} HAVE_LINKER_${{linker}})
+        if(HAVE_LINKER_${{linker}})
+            add_link_options(-fuse-ld=${{linker}})
+            break()
+        endif()
+    endforeach()
+endif()
+)";
+
+constexpr std::string_view ipo_block = R"(
+include(CheckIPOSupported)
+check_ipo_supported(RESULT IPO_SUPPORTED LANGUAGES {0})
+if(IPO_SUPPORTED AND NOT DEFINED CMAKE_INTERPROCEDURAL_OPTIMIZATION)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELEASE ON)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELWITHDEBINFO ON)
+endif()
+)";
+
+constexpr std::string_view split_dwarf_block = R"(
+if(CMAKE_{0}_COMPILER_ID MATCHES "GNU|Clang" AND NOT WIN32)
+    add_compile_options($<$<OR:$<CONFIG:Debug>,$<CONFIG:RelWithDebInfo>>:-gsplit-dwarf>)
+endif()
+)";
+
+struct BuildProfile
 {
-    printf("Hello World");
-    return 0;
-})";
+    std::string_view name;
+    bool unity_build;
+    bool launcher;
+    bool fast_linker;
+    bool ipo;
+    bool split_dwarf;
+};
+
+// dev favors incremental rebuilds and debugging, release favors full builds and the final binary
+constexpr std::array build_profiles{
+    BuildProfile{ "none", false, false, false, false, false },
+    BuildProfile{ "dev", false, true, true, false, true },
+    BuildProfile{ "release", true, true, true, true, false },
+};
 
-constexpr std::string_view cxx_example = R"(#include <iostream>
-int main()
+// check_linker_flag needs CMake 3.18
+constexpr std::string_view profile_min_version = "3.18";
+
+static const BuildProfile *find_build_profile(std::string_view name)
+{
+    for (auto &&profile : build_profiles)
+    {
+        if (profile.name == name)
+        {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
+
+static std::string build_profile_block(const BuildProfile &profile, std::string_view lang)
 {
-    std::cout << "Hello World" << std::endl;
-})";
+    std::string block;
+    if (profile.unity_build)
+    {
+        block += unity_build_block;
+    }
+    if (profile.launcher)
+    {
+        block += std::format(launcher_block, lang);
+    }
+    if (profile.fast_linker)
+    {
+        block += std::format(fast_linker_block, lang);
+    }
+    if (profile.ipo)
+    {
+        block += std::format(ipo_block, lang);
+    }
+    if (profile.split_dwarf)
+    {
+        block += std::format(split_dwarf_block, lang);
+    }
+    return block;
+}
 
-constexpr std::string_view cxx23_example = R"(#include <print>
-int main()
+enum class HeaderMode
 {
-    std::println("Hello World");
-})";
+    include,
+    pch,
+    module
+};
 
-constexpr std::string_view cmake_template = R"(cmake_minimum_required(VERSION {0})
+// Cached configs bypass argparse, which takes any integer anyway, so standards are checked before use
+static bool check_standard(SourceLang lang, int standard)
+{
+    if (source_template(lang, standard))
+    {
+        return true;
+    }
 
-set(CMAKE_C_STANDARD {1})
-set(CMAKE_CXX_STANDARD {2})
-{5}
-project({3})
+    std::string expected;
+    for (int known : known_standards(lang))
+    {
+        expected += expected.empty() ? "" : ", ";
+        expected += std::to_string(known);
+    }
+    log_err("Unknown {} standard {}, expected one of {}.", lang == SourceLang::C ? "C" : "C++", standard, expected);
+    return false;
+}
+
+static std::optional<HeaderMode> parse_header_mode(std::string_view mode)
+{
+    if (mode == "include")
+    {
+        return HeaderMode::include;
+    }
+    if (mode == "pch")
+    {
+        return HeaderMode::pch;
+    }
+    if (mode == "module")
+    {
+        return HeaderMode::module;
+    }
+    return std::nullopt;
+}
+
+// Compares dotted versions component by component, missing components count as 0
+static bool version_less(std::string_view lhs, std::string_view rhs)
+{
+    while (!lhs.empty() || !rhs.empty())
+    {
+        int l = 0, r = 0;
+        auto [lhs_end, lhs_ec] = std::from_chars(lhs.data(), lhs.data() + lhs.size(), l);
+        auto [rhs_end, rhs_ec] = std::from_chars(rhs.data(), rhs.data() + rhs.size(), r);
+        if (l != r)
+        {
+            return l < r;
+        }
+
+        lhs.remove_prefix(std::min(lhs.size(), static_cast<std::size_t>(lhs_end - lhs.data()) + 1));
+        rhs.remove_prefix(std::min(rhs.size(), static_cast<std::size_t>(rhs_end - rhs.data()) + 1));
+    }
+    return false;
+}
+
+// `<min>[...<max>]` as cmake_minimum_required takes it, max is empty without a policy range
+struct VersionRange
+{
+    std::string_view min;
+    std::string_view max;
+};
+
+static VersionRange split_version_range(std::string_view version)
+{
+    auto dots = version.find("...");
+    if (dots == std::string_view::npos)
+    {
+        return { version, {} };
+    }
+    return { version.substr(0, dots), version.substr(dots + 3) };
+}
+
+struct CMakeEdit
+{
+    std::size_t offset;
+    std::size_t length;
+    std::string replacement;
+};
+
+// Only what was asked for is patched, defaults of the generator do not apply to existing projects
+struct CMakeTargets
+{
+    std::optional<std::string_view> version;
+    std::optional<int> cstd;
+    std::optional<int> cxxstd;
+};
+
+static bool iequals(std::string_view lhs, std::string_view rhs)
+{
+    return std::ranges::equal(lhs, rhs, [](char l, char r) { return std::tolower(l) == std::tolower(r); });
+}
+
+// Values that are not plain numbers, e.g. variable references, are left alone
+static bool standard_less(std::string_view current, int target)
+{
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(current.data(), current.data() + current.size(), value);
+    if (ec != std::errc{} || ptr != current.data() + current.size())
+    {
+        return false;
+    }
+    return detail::standard_year(value) < detail::standard_year(target);
+}
+
+// Plans the edits that raise the minimum version and the standards of an existing CMakeLists.txt. Values are only
+// ever raised, so projects that are already ahead are untouched. Empty if the source does not parse
+static std::optional<std::vector<CMakeEdit>> plan_cmake_edits(std::string_view source, const CMakeTargets &targets)
+{
+    std::vector<CMakeEdit> edits;
+    CMakeLexer lexer{ source };
+    CMakeCommand command;
+
+    auto edit = [&](std::string_view value, std::string replacement)
+    { edits.push_back({ lexer.offset_of(value), value.size(), std::move(replacement) }); };
+
+    auto bump_standard = [&](std::string_view value, std::optional<int> target)
+    {
+        if (target && standard_less(value, *target))
+        {
+            edit(value, std::to_string(*target));
+        }
+    };
+
+    auto bump_standard_property = [&](std::string_view key, std::string_view value)
+    {
+        if (key == "C_STANDARD" || key == "CMAKE_C_STANDARD")
+        {
+            bump_standard(value, targets.cstd);
+        }
+        else if (key == "CXX_STANDARD" || key == "CMAKE_CXX_STANDARD")
+        {
+            bump_standard(value, targets.cxxstd);
+        }
+    };
+
+    VersionRange target_range = split_version_range(targets.version.value_or(""));
+    auto bump_version = [&](std::string_view value, std::string_view target)
+    {
+        if (targets.version && version_less(value, target))
+        {
+            edit(value, std::string{ target });
+        }
+    };
+
+    while (lexer.next(command))
+    {
+        auto &args = command.arguments;
+        if (iequals(command.name, "cmake_minimum_required"))
+        {
+            for (std::size_t i = 0; i + 1 < args.size(); ++i)
+            {
+                if (args[i].value != "VERSION")
+                {
+                    continue;
+                }
+
+                // VERSION <min>[...<max>], the policy max is raised along if it would fall behind
+                auto [lower, upper] = split_version_range(args[i + 1].value);
+                bump_version(lower, target_range.min);
+                if (!upper.empty())
+                {
+                    bump_version(upper, target_range.max.empty() ? target_range.min : target_range.max);
+                }
+                break;
+            }
+        }
+        else if (iequals(command.name, "set"))
+        {
+            if (args.size() >= 2)
+            {
+                bump_standard_property(args[0].value, args[1].value);
+            }
+        }
+        else if (iequals(command.name, "set_target_properties") || iequals(command.name, "set_property"))
+        {
+            for (std::size_t i = 0; i + 1 < args.size(); ++i)
+            {
+                bump_standard_property(args[i].value, args[i + 1].value);
+            }
+        }
+        else if (iequals(command.name, "target_compile_features"))
+        {
+            for (auto &&arg : args)
+            {
+                if (arg.value.starts_with("c_std_"))
+                {
+                    bump_standard(arg.value.substr(6), targets.cstd);
+                }
+                else if (arg.value.starts_with("cxx_std_"))
+                {
+                    bump_standard(arg.value.substr(8), targets.cxxstd);
+                }
+            }
+        }
+    }
+
+    if (lexer.failed())
+    {
+        return std::nullopt;
+    }
+    return edits;
+}
+
+// Everything outside the edited ranges is copied byte for byte
+static std::string apply_cmake_edits(std::string_view source, const std::vector<CMakeEdit> &edits)
+{
+    std::size_t size = source.size();
+    for (auto &&edit : edits)
+    {
+        size = size - edit.length + edit.replacement.size();
+    }
+
+    std::string out;
+    out.reserve(size);
+    std::size_t pos = 0;
+    for (auto &&edit : edits)
+    {
+        out.append(source, pos, edit.offset - pos);
+        out += edit.replacement;
+        pos = edit.offset + edit.length;
+    }
+    out.append(source, pos);
+    return out;
+}
+
+constexpr std::string_view export_commands_block = "\nset(CMAKE_EXPORT_COMPILE_COMMANDS ON)\n";
+
+// Slot of cmake_template bound per project, every other slot only depends on the config
+constexpr std::size_t project_slot = 3;
+constexpr std::size_t cmake_template_slots = 12;
+
+// Bumped when the way the config slots are computed changes, e.g. in build_profile_block, without any of the inputs
+// hashed below changing
+constexpr std::string_view specialization_format_version = "1";
+
+// Changes whenever one of the inputs of the config slots does, so that cached specializations built from older ones
+// are never used
+constexpr std::uint64_t templates_hash = []
+{
+    std::uint64_t hash = 0;
+    auto mix = [&](std::string_view value) { hash = (hash ^ fnv1a(value)) * 0x100000001b3ull; };
+    for (auto text : { specialization_format_version,
+                       cmake_template,
+                       bench_subdirectory,
+                       profiling_block,
+                       pgo_training_block,
+                       pch_template,
+                       import_std_gate,
+                       import_std_template,
+                       unity_build_block,
+                       launcher_block,
+                       fast_linker_block,
+                       ipo_block,
+                       split_dwarf_block,
+                       export_commands_block,
+                       pch_min_version,
+                       profile_min_version,
+                       fetch_content_min_version })
+    {
+        mix(text);
+    }
+    for (auto &&profile : build_profiles)
+    {
+        mix(profile.name);
+        for (bool setting :
+             { profile.unity_build, profile.launcher, profile.fast_linker, profile.ipo, profile.split_dwarf })
+        {
+            mix(setting ? "1" : "0");
+        }
+    }
+    // Only the filename and headers of a source template reach cmake_template
+    for (auto &&variant : detail::source_variants)
+    {
+        mix(variant.source.filename);
+        mix(variant.source.headers);
+        mix(variant.source.modular.size() != 0 ? "1" : "0");
+    }
+    return hash;
+}();
+
+// Identifies the options cmake_template's config slots are bound from, along with the templates themselves
+static std::string template_fingerprint()
+{
+    std::uint64_t hash = templates_hash;
+    auto mix = [&](std::string_view value) { hash = (hash ^ fnv1a(value)) * 0x100000001b3ull; };
+    mix(*Args::CMAKE_VERSION);
+    mix(std::to_string(*Args::CMAKE_CSTD));
+    mix(std::to_string(*Args::CMAKE_CXXSTD));
+    mix(*Args::CMAKE_MAINLANG);
+    mix(*Args::CMAKE_HEADERMODE);
+    mix(*Args::CMAKE_BUILDPROFILE);
+    mix(*Args::CMAKE_EXPORTCMD ? "1" : "0");
+    mix(*Args::CMAKE_WITHBENCH ? "1" : "0");
+    mix(*Args::CMAKE_WITHPROFILING ? "1" : "0");
+    mix(*Args::CMAKE_PRESETS ? "1" : "0");
+    return std::format("{:016x}", hash);
+}
+
+// cmake_template with its config slots bound, keyed by template_fingerprint(). Filled from the config cache
+// and by CMakeOutput, saved back along with the config
+static KeyTable<PartialTemplate> &specialized_templates()
+{
+    static KeyTable<PartialTemplate> templates;
+    return templates;
+}
+
+// Indexes the entries of a YAML map by the hash of their keys
+static KeyTable<YAML::Node> index_map(const YAML::Node &node)
+{
+    KeyTable<YAML::Node> table{ node.IsMap() ? node.size() : 0 };
+    if (!node.IsMap())
+    {
+        return table;
+    }
+
+    for (auto &&entry : node)
+    {
+        if (entry.first.IsScalar())
+        {
+            table.insert_or_assign(entry.first.Scalar(), entry.second);
+        }
+    }
+
+    return table;
+}
+
+// Last line of the cache file, a YAML comment so that the file stays editable by hand
+constexpr std::string_view cache_checksum_prefix = "# filetemp-crc32c: ";
+
+// Caches without a checksum line, e.g. written by older versions, are accepted as is
+static bool verify_cache_text(std::string_view text)
+{
+    auto pos = text.rfind(cache_checksum_prefix);
+    if (pos == std::string_view::npos || (pos != 0 && text[pos - 1] != '\n'))
+    {
+        return true;
+    }
+
+    std::uint32_t expected = 0;
+    auto digits = text.substr(pos + cache_checksum_prefix.size());
+    auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), expected, 16);
+    if (ec != std::errc{})
+    {
+        return false;
+    }
+
+    return crc32c(std::as_bytes(std::span{ text.substr(0, pos) })) == expected;
+}
+
+// Where configs saved before the render cache kept their specialized template
+constexpr std::string_view specialized_template_key = "specialized-template";
+
+struct CacheIO
+{
+    YAML::Node &cache;
+    KeyTable<YAML::Node> options = index_map(cache);
+
+    template <typename T>
+    void do_include(Arg<T> &arg)
+    {
+        // Options given on the command line win over configs
+        if (arg.given())
+        {
+            return;
+        }
+
+        YAML::Node *option = options.find(arg.hash(), arg.name());
+        if (!option)
+        {
+            return;
+        }
+
+        try
+        {
+            arg.assign(option->template as<T>());
+        }
+        catch (const YAML::InvalidNode &)
+        {
+            return;
+        }
+        catch (const YAML::BadConversion &)
+        {
+            log_err("Cache file corrupted, arguments may not work as expected.");
+        }
+    }
+
+    template <typename T>
+    void do_save(const Arg<T> &arg)
+    {
+        if (YAML::Node *option = options.find(arg.hash(), arg.name()))
+        {
+            *option = *arg;
+        }
+        else
+        {
+            cache[arg.name()] = *arg;
+        }
+    }
+};
+
+// The options a config saves and restores
+static auto config_args()
+{
+    return std::tie(Args::CMAKE_VERSION,
+                    Args::CMAKE_CSTD,
+                    Args::CMAKE_CXXSTD,
+                    Args::CMAKE_EXPORTCMD,
+                    Args::CMAKE_MAINLANG,
+                    Args::CMAKE_HEADERMODE,
+                    Args::CMAKE_BUILDPROFILE,
+                    Args::CMAKE_PRESETS,
+                    Args::CMAKE_WITHBENCH,
+                    Args::CMAKE_WITHPROFILING);
+}
+
+template <typename F>
+static void for_each_config_arg(F &&f)
+{
+    std::apply([&](auto &...args) { (f(args), ...); }, config_args());
+}
+
+// Holds the config cache and the output registry, empty if it cannot be located
+static std::filesystem::path cache_dir()
+{
+#ifdef FT_PLATFORM_WINDOWS
+    const char *cache_root = std::getenv("LOCALAPPDATA");
+#elifdef FT_PLATFORM_UNIX
+    const char *cache_root = std::getenv("HOME");
+#else
+#error "System not supported."
+#endif
+    if (!cache_root)
+    {
+        return {};
+    }
+    return std::filesystem::path{ cache_root } / ".filetemp";
+}
+
+// Maps each directory generated from a config to the options it was generated with, for `watch`
+constexpr std::string_view outputs_file_name = "cmake-outputs.yaml";
+
+static std::string read_text(const std::filesystem::path &path)
+{
+    std::string text;
+    if (auto open_result = File::create(path, FileMode::read))
+    {
+        File &file = open_result.value();
+        text.resize(file.size());
+        if (!file.read(std::as_writable_bytes(std::span{ text })))
+        {
+            text.clear();
+        }
+    }
+    return text;
+}
+
+// Null if the cache is missing or unreadable
+static YAML::Node read_cache(const std::filesystem::path &path)
+{
+    metrics::ScopedTimer timer{ metrics::Timer::cache_load };
+    std::string text = read_text(path);
+    if (text.empty())
+    {
+        return {};
+    }
+
+    if (!verify_cache_text(text))
+    {
+        log_err("Cache file checksum mismatch, it was edited by hand or is corrupted.");
+    }
+
+    try
+    {
+        return YAML::Load(text);
+    }
+    catch (std::exception &)
+    {
+        return {};
+    }
+}
+
+// Written next to `path` and renamed over it, so that readers never observe a partial file and need no lock
+template <typename F>
+static bool replace_file_with(const std::filesystem::path &path, F &&write)
+{
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        auto tmp_create_result = File::create(tmp_path, FileMode::write);
+        if (!tmp_create_result)
+        {
+            log_err("{}", tmp_create_result.error().msg());
+            return false;
+        }
+
+        auto &tmp_file = tmp_create_result.value();
+        if (!write(tmp_file) || !tmp_file.close())
+        {
+            log_err("Failed to write into \"{}\".", tmp_path.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec)
+    {
+        log_err("Failed to replace \"{}\".", path.string());
+        return false;
+    }
+    return true;
+}
+
+static bool replace_file(const std::filesystem::path &path, std::string_view text)
+{
+    return replace_file_with(path, [&](File &file) { return file.write(text).has_value(); });
+}
+
+// Specialized templates of the saved configs, one record per config, next to the config cache. Kept out of the
+// YAML, so that loading one is a checksum and a copy instead of parsing the template text
+constexpr std::string_view render_cache_file_name = "cmake-templates.bin";
+// "FTRC" once encoded little-endian
+constexpr std::uint32_t render_cache_magic = 0x43525446;
+constexpr std::uint16_t render_cache_version = 1;
+
+// Followed in the payload by the config name, the fingerprint and the text
+struct RenderCacheRecord : SchemaRecord<RenderCacheRecord>
+{
+    std::uint32_t config_size = 0;
+    std::uint32_t fingerprint_size = 0;
+    std::uint32_t text_size = 0;
+
+    static constexpr auto schema = std::tuple{ &RenderCacheRecord::config_size,
+                                               &RenderCacheRecord::fingerprint_size,
+                                               &RenderCacheRecord::text_size };
+};
+
+struct RenderCacheEntry
+{
+    std::string config;
+    std::string fingerprint;
+    std::string text;
+};
+
+// The file is a BinaryHeader, the records and a checksum trailer over both. Empty if the file is missing, from another
+// version or corrupted, the templates are specialized again then
+static std::vector<RenderCacheEntry> read_render_cache(const std::filesystem::path &path)
+{
+    auto file_open_result = File::create(path, FileMode::read);
+    if (!file_open_result)
+    {
+        return {};
+    }
+
+    auto &file = file_open_result.value();
+    if (auto verify_result = file.verify_checksum_trailer(); !verify_result)
+    {
+        log_err("{}", verify_result.error().msg());
+        return {};
+    }
+
+    BinaryHeader header;
+    if (!file.read(header) || header.payload_size > file.size())
+    {
+        return {};
+    }
+
+    std::vector<std::byte> payload(static_cast<std::size_t>(header.payload_size));
+    if (!file.read_range(std::span{ payload }) ||
+        !header.verify(render_cache_magic, render_cache_version, payload))
+    {
+        return {};
+    }
+
+    std::vector<RenderCacheEntry> entries;
+    std::span<const std::byte> rest{ payload };
+    auto take = [&](std::uint32_t size)
+    {
+        std::string value(reinterpret_cast<const char *>(rest.data()), size);
+        rest = rest.subspan(size);
+        return value;
+    };
+    while (!rest.empty())
+    {
+        constexpr std::size_t record_size = schema_size<RenderCacheRecord>();
+        RenderCacheRecord record;
+        if (rest.size() < record_size)
+        {
+            return {};
+        }
+        schema_decode(record, rest.first(record_size));
+        rest = rest.subspan(record_size);
+
+        if (rest.size() < std::size_t{ record.config_size } + record.fingerprint_size + record.text_size)
+        {
+            return {};
+        }
+        auto &entry = entries.emplace_back();
+        entry.config = take(record.config_size);
+        entry.fingerprint = take(record.fingerprint_size);
+        entry.text = take(record.text_size);
+    }
+    return entries;
+}
+
+static bool write_render_cache(const std::filesystem::path &path, const std::vector<RenderCacheEntry> &entries)
+{
+    std::vector<std::byte> payload;
+    auto append = [&](std::string_view value)
+    {
+        auto bytes = std::as_bytes(std::span{ value });
+        payload.insert(payload.end(), bytes.begin(), bytes.end());
+    };
+    for (auto &&entry : entries)
+    {
+        RenderCacheRecord record;
+        record.config_size = static_cast<std::uint32_t>(entry.config.size());
+        record.fingerprint_size = static_cast<std::uint32_t>(entry.fingerprint.size());
+        record.text_size = static_cast<std::uint32_t>(entry.text.size());
+
+        std::size_t offset = payload.size();
+        payload.resize(offset + schema_size<RenderCacheRecord>());
+        schema_encode(record, std::span{ payload }.subspan(offset));
+        append(entry.config);
+        append(entry.fingerprint);
+        append(entry.text);
+    }
+
+    auto header = BinaryHeader::make(render_cache_magic, render_cache_version, payload);
+    return replace_file_with(path,
+                             [&](File &file)
+                             {
+                                 file.enable_checksum();
+                                 return file.write(header) && file.write_range(std::span<const std::byte>{ payload }) &&
+                                        file.write_checksum_trailer();
+                             });
+}
+
+namespace ft
+{
+CMakeCacher::CMakeCacher() noexcept
+{
+    FT_TRACE_SCOPE("CMakeCacher::CMakeCacher");
+    std::string cfg;
+    YAML::Node cfg_cache;
+    bool use_config = Args::CMAKE_USECONFIG.given();
+    if (use_config)
+    {
+        cfg = *Args::CMAKE_USECONFIG;
+    }
+
+    if (!use_config && !Args::CMAKE_SAVEAS.given())
+    {
+        return;
+    }
+
+    if (auto dir = cache_dir(); !dir.empty())
+    {
+        m_cachePath = dir / "cmake.yaml";
+    }
+
+    // Writers replace the cache file atomically, so readers never observe a partial file and need no lock
+    if (!load_cache())
+    {
+        if (use_config)
+        {
+            log_err("Failed to load cache file, config related options may not work as expected.");
+        }
+        return;
+    }
+
+    YAML::Node *found = m_configs.find(cfg);
+    if (found)
+    {
+        cfg_cache = *found;
+    }
+    if (use_config)
+    {
+        metrics::count_config(cfg, found);
+    }
+
+    CacheIO includer{ cfg_cache };
+    for_each_config_arg([&](auto &arg) { includer.do_include(arg); });
+
+    if (!use_config || !found)
+    {
+        return;
+    }
+
+    // Only a cache, without a record the template is specialized again
+    for (auto &&entry : read_render_cache(m_cachePath.parent_path() / render_cache_file_name))
+    {
+        if (entry.config != cfg)
+        {
+            continue;
+        }
+        if (auto parsed = PartialTemplate::parse(entry.text))
+        {
+            specialized_templates().insert_or_assign(entry.fingerprint, std::move(*parsed));
+        }
+        break;
+    }
+}
+
+bool CMakeCacher::load_cache()
+{
+    m_cache = read_cache(m_cachePath);
+    m_configs = index_map(m_cache);
+    return !m_cache.IsNull();
+}
+
+// What `watch` needs to regenerate a directory from `config`: the options it was generated with, and which of them
+// were given on the command line and so do not follow the config
+static YAML::Node output_record(std::string_view config, std::string_view project)
+{
+    YAML::Node args;
+    YAML::Node given{ YAML::NodeType::Sequence };
+    CacheIO recorder{ args };
+    auto record = [&](auto &arg)
+    {
+        recorder.do_save(arg);
+        if (arg.given())
+        {
+            given.push_back(std::string{ arg.name() });
+        }
+    };
+    for_each_config_arg(record);
+    record(Args::CMAKE_GENSRC);
+    args[Args::CMAKE_PROJECT.name()] = std::string{ project };
+
+    YAML::Node entry;
+    entry["config"] = std::string{ config };
+    entry["given"] = given;
+    entry["args"] = args;
+    return entry;
+}
+
+using OutputRecords = std::vector<std::pair<std::string, YAML::Node>>;
+
+static std::string output_directory(const std::filesystem::path &directory)
+{
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(directory, ec);
+    return ec ? std::string{} : absolute.lexically_normal().generic_string();
+}
+
+// Directories the generator failed to write, or that were deleted since, are not worth regenerating
+static bool has_output(const std::string &directory)
+{
+    std::error_code ec;
+    return !directory.empty() && std::filesystem::exists(std::filesystem::path{ directory } / "CMakeLists.txt", ec);
+}
+
+// Adds the records to the registry under a single lock, dropping the directories that no longer have a CMakeLists.txt
+static void record_outputs(const std::filesystem::path &outputs_path, const OutputRecords &records)
+{
+    if (records.empty())
+    {
+        return;
+    }
+
+    auto lock_path = outputs_path;
+    lock_path += ".lock";
+    auto lock_result = FileLock::acquire(lock_path, LockMode::exclusive);
+    if (!lock_result)
+    {
+        log_err("Failed to lock the output registry, watch will not regenerate the {} directories generated.",
+                records.size());
+        return;
+    }
+
+    YAML::Node outputs;
+    try
+    {
+        outputs = YAML::Load(read_text(outputs_path));
+    }
+    catch (const YAML::Exception &)
+    {
+        // Rebuilt from the outputs generated from now on
+    }
+
+    // Appended without lookups, the latest record of a directory replaces the others
+    KeyTable<bool> recorded{ records.size() };
+    YAML::Node kept{ YAML::NodeType::Map };
+    for (auto it = records.rbegin(); it != records.rend(); ++it)
+    {
+        auto &&[directory, entry] = *it;
+        if (has_output(directory) && !recorded.find(directory))
+        {
+            recorded.insert_or_assign(directory, true);
+            kept.force_insert(directory, entry);
+        }
+    }
+    if (outputs.IsMap())
+    {
+        for (auto &&output : outputs)
+        {
+            if (!output.first.IsScalar() || recorded.find(output.first.Scalar()) || !has_output(output.first.Scalar()))
+            {
+                continue;
+            }
+            kept.force_insert(output.first, output.second);
+        }
+    }
+
+    std::stringstream yaml_result;
+    yaml_result << kept << '\n';
+    replace_file(outputs_path, yaml_result.view());
+}
+
+void CMakeCacher::record_output()
+{
+    // Manifests record their outputs in one batch, see CMakeOutput::Impl::output_manifest
+    if (!*Args::CMAKE_WATCHABLE || !Args::CMAKE_USECONFIG.given() || m_cachePath.empty() || *Args::CMAKE_UPDATE ||
+        Args::CMAKE_MANIFEST.given())
+    {
+        return;
+    }
+
+    OutputRecords records;
+    records.emplace_back(output_directory(*Args::CMAKE_WORKDIRECTORY),
+                         output_record(*Args::CMAKE_USECONFIG, *Args::CMAKE_PROJECT));
+    record_outputs(m_cachePath.parent_path() / outputs_file_name, records);
+}
+
+void CMakeCacher::update()
+{
+    FT_TRACE_SCOPE("CMakeCacher::update");
+    record_output();
+
+    if (!Args::CMAKE_SAVEAS.given())
+    {
+        return;
+    }
+
+    YAML::Node save_cache;
+    const std::string &cfg = *Args::CMAKE_SAVEAS;
+
+    if (m_cachePath.empty())
+    {
+        log_err("Failed to locate cache, save-as may not work as expected.");
+        return;
+    }
+
+    metrics::ScopedTimer timer{ metrics::Timer::cache_save };
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_cachePath.parent_path(), ec);
+
+    auto lock_path = m_cachePath;
+    lock_path += ".lock";
+    auto lock_result = FileLock::acquire(lock_path, LockMode::exclusive);
+    if (!lock_result)
+    {
+        log_err("Failed to lock cache, save-as may not work as expected.");
+        return;
+    }
+
+    // Other processes may have saved their configs since the cache was loaded, merge into the latest one
+    load_cache();
+
+    if (YAML::Node *found = m_configs.find(cfg))
+    {
+        save_cache = *found;
+    }
+    else
+    {
+        save_cache = m_cache[cfg];
+        m_configs.insert_or_assign(cfg, save_cache);
+    }
+
+    CacheIO saver{ save_cache };
+    for_each_config_arg([&](auto &arg) { saver.do_save(arg); });
+
+    // Configs saved before the render cache kept their template here
+    save_cache.remove(specialized_template_key);
+
+    std::stringstream yaml_result;
+    yaml_result << m_cache << '\n';
+    std::uint32_t checksum = crc32c(std::as_bytes(std::span{ yaml_result.view() }));
+    yaml_result << cache_checksum_prefix << std::format("{:08x}", checksum) << '\n';
+
+    if (!replace_file(m_cachePath, yaml_result.view()))
+    {
+        log_err("Failed to save cache, save-as may not work as expected.");
+        return;
+    }
+
+    // Under the same lock as the config cache, records of configs it no longer has are dropped
+    auto render_cache_path = m_cachePath.parent_path() / render_cache_file_name;
+    auto entries = read_render_cache(render_cache_path);
+    std::erase_if(entries,
+                  [&](const RenderCacheEntry &entry) { return entry.config == cfg || !m_configs.find(entry.config); });
+    auto fingerprint = template_fingerprint();
+    if (PartialTemplate *specialized = specialized_templates().find(fingerprint))
+    {
+        entries.push_back({ cfg, fingerprint, std::string{ specialized->text() } });
+    }
+    write_render_cache(render_cache_path, entries);
+}
 
-add_executable({3})
-target_sources({3} PRIVATE src/main.{4})
-target_include_directories({3} PRIVATE src))";
+// A project rendered by the generator and waiting to be written. Only its CMakeLists.txt is owned, the other files
+// are embedded templates
+struct RenderedProject
+{
+    // Relative to the base directory when written below one
+    std::filesystem::path directory;
+    std::string cmake_lists;
+    // Written after CMakeLists.txt, the first that fails stops the project
+    std::vector<std::pair<std::string_view, std::string_view>> files;
+    // Name in src/ of the generated source, failing to write it is only reported
+    std::string_view source_name;
+    std::string_view source;
+    bool show = false;
+    std::chrono::steady_clock::time_point started;
 
-struct CacheIO
+    // Memory held until the project is written
+    std::size_t footprint(this const RenderedProject &self)
+    {
+        return sizeof(RenderedProject) + self.cmake_lists.capacity() +
+               self.directory.native().size() * sizeof(std::filesystem::path::value_type) +
+               self.files.capacity() * sizeof(self.files.front());
+    }
+};
+
+// Unchanged files keep their modification time, so regenerating a project does not trigger a rebuild. Only reads
+// the project, never Args, so that it can run while the next projects are rendered
+static bool write_project_files(const RenderedProject &project, DirMaterializer *base)
 {
-    argparse::ArgumentParser &parser;
-    YAML::Node &cache;
+    auto dirs_open_result = base ? base->subdir(project.directory) : DirMaterializer::open(project.directory);
+    if (!dirs_open_result)
+    {
+        WithSourceLocation{}.log_err("{}", dirs_open_result.error().msg());
+        return false;
+    }
 
-    template <typename T>
-    void do_include(Arg<T> &arg)
+    // Every file is created through it, so each directory is created or checked once per project
+    auto &dirs = dirs_open_result.value();
+    auto write_file = [&](const std::filesystem::path &relative, std::string_view content)
     {
-        if (parser.is_used(arg.full_name()))
+        auto file_write_result = dirs.write_if_changed(relative, content);
+        if (!file_write_result)
         {
-            return;
+            log_err("{}", file_write_result.error().msg());
+            return false;
         }
+        return true;
+    };
 
-        try
-        {
-            arg.assign(cache[arg.name()].template as<T>());
-        }
-        catch (const YAML::InvalidNode &)
-        {
-            return;
-        }
-        catch (const YAML::BadConversion &)
+    if (!write_file("CMakeLists.txt", project.cmake_lists))
+    {
+        return false;
+    }
+
+    if (project.show)
+    {
+        std::cout << project.cmake_lists;
+    }
+
+    for (auto &&[relative, content] : project.files)
+    {
+        if (!write_file(relative, content))
         {
-            log_err("Cache file corrupted, arguments may not work as expected.");
+            return false;
         }
     }
 
-    template <typename T>
-    void do_save(const Arg<T> &arg)
+    if (!project.source_name.empty() &&
+        !write_file(std::filesystem::path{ "src" } / project.source_name, project.source))
     {
-        cache[arg.name()] = *arg;
+        log_err("Failed to generate source files.");
     }
-};
+    return true;
+}
 
-namespace ft
+// Files that failed to flush or close while being destroyed fail the project that wrote them, on the thread that did
+static bool write_project(const RenderedProject &project, DirMaterializer *base = nullptr)
 {
-CMakeCacher::CMakeCacher(argparse::ArgumentParser &parser) noexcept
-    : r_parser(parser)
-{
-    std::string_view cfg;
-    YAML::Node cfg_cache;
-    bool use_config = false;
-    if (auto used_cfg = parser.present(Args::CMAKE_USECONFIG.full_name()))
+    FT_TRACE_SCOPE("write_project");
+    bool written = write_project_files(project, base);
+    for (auto &&error : File::take_deferred_errors())
     {
-        cfg = used_cfg.value();
-        use_config = true;
+        log_err("{}", error.msg());
+        written = false;
     }
 
-    if (use_config || parser.present(Args::CMAKE_SAVEAS.full_name()))
+    if (written)
     {
-        try
-        {
-#ifdef FT_PLATFORM_WINDOWS
-            const char *cache_root = std::getenv("LOCALAPPDATA");
-#elifdef FT_PLATFORM_UNIX
-            const char *cache_root = std::getenv("HOME");
-#else
-#error "System not supported."
-#endif
-            if (cache_root)
-            {
-                m_cachePath = cache_root;
-                (m_cachePath /= ".filetemp") /= "cmake.yaml";
-            }
-            m_cache = YAML::LoadFile(m_cachePath.string());
-        }
-        catch (std::exception &)
-        {
-            if (use_config)
-            {
-                log_err("Failed to load cache file, config related options may not work as expected.");
-            }
-            m_cache = YAML::Node{};
-            return;
-        }
+        metrics::add(metrics::Counter::projects_generated);
     }
-    else
+    return written;
+}
+
+// Writes rendered projects on a thread of its own, so that rendering the next projects overlaps with the file I/O of
+// the previous ones. The projects submitted but not yet written are bounded in number and in memory, a slow
+// filesystem makes submit() wait instead of piling them up
+class WritePipeline
+{
+public:
+    static constexpr std::size_t max_pending = 256;
+    static constexpr std::size_t memory_budget = std::size_t{ 64 } << 20;
+
+    // `base` is only used by the writer thread from now on
+    explicit WritePipeline(DirMaterializer &base)
+        : m_base(base)
     {
-        return;
+        // Loggers are created on first use, which is not thread-safe
+        validate_stdout_logger();
+        validate_stderr_logger();
+        m_writer = std::jthread{ [this] { this->run(); } };
     }
 
-    cfg_cache = m_cache[cfg];
-
-    CacheIO includer{ parser, cfg_cache };
+    WritePipeline(const WritePipeline &) = delete;
+    WritePipeline &operator=(const WritePipeline &) = delete;
 
-    includer.do_include(Args::CMAKE_VERSION);
-    includer.do_include(Args::CMAKE_CSTD);
-    includer.do_include(Args::CMAKE_CXXSTD);
-    includer.do_include(Args::CMAKE_EXPORTCMD);
-    includer.do_include(Args::CMAKE_MAINLANG);
-}
+    ~WritePipeline() { finish(); }
 
-void CMakeCacher::update()
-{
-    YAML::Node save_cache;
-    std::string cfg;
-    if (auto saved_cfg = r_parser.present(Args::CMAKE_SAVEAS.full_name()))
+    // Blocks while the budget is used up, collecting the projects written meanwhile
+    void submit(this WritePipeline &self, RenderedProject project)
     {
-        cfg = saved_cfg.value();
+        std::size_t footprint = project.footprint();
+        // A project larger than the whole budget still goes through, alone
+        while (self.m_pending == max_pending ||
+               (self.m_pending != 0 && self.m_pending_bytes + footprint > memory_budget))
+        {
+            self.complete(*self.m_completions.pop());
+        }
+        while (auto completion = self.m_completions.try_pop())
+        {
+            self.complete(*completion);
+        }
+
+        ++self.m_pending;
+        self.m_pending_bytes += footprint;
+        self.m_requests.push({ std::move(project), footprint });
     }
-    else
+
+    // Waits until every submitted project is written
+    void finish(this WritePipeline &self)
     {
-        return;
+        if (!self.m_writer.joinable())
+        {
+            return;
+        }
+
+        self.m_requests.close();
+        while (self.m_pending != 0)
+        {
+            self.complete(*self.m_completions.pop());
+        }
+        self.m_writer.join();
     }
-    save_cache = m_cache[std::string_view{ cfg }];
 
-    CacheIO saver{ r_parser, save_cache };
+    std::size_t written(this const WritePipeline &self) { return self.m_written; }
+    std::size_t failed(this const WritePipeline &self) { return self.m_failed; }
 
-    saver.do_save(Args::CMAKE_VERSION);
-    saver.do_save(Args::CMAKE_CSTD);
-    saver.do_save(Args::CMAKE_CXXSTD);
-    saver.do_save(Args::CMAKE_EXPORTCMD);
-    saver.do_save(Args::CMAKE_MAINLANG);
+private:
+    struct Request
+    {
+        RenderedProject project;
+        std::size_t footprint = 0;
+    };
 
-    auto cache_open_result = File::create(m_cachePath, FileMode::write);
-    if (!cache_open_result)
+    struct Completion
     {
-        log_err("Failed to save cache, save-as may not work as expected.");
-        return;
-    }
+        std::size_t footprint = 0;
+        bool written = false;
+    };
 
-    File &cache_file = cache_open_result.value();
-    std::stringstream yaml_result;
-    yaml_result << m_cache;
+    void run(this WritePipeline &self)
+    {
+        while (auto request = self.m_requests.pop())
+        {
+            bool written = write_project(request->project, &self.m_base);
+            metrics::record(metrics::Timer::generate, std::chrono::steady_clock::now() - request->project.started);
+            self.m_completions.push({ request->footprint, written });
+        }
+    }
 
-    auto cache_write_result = cache_file.write(yaml_result.view());
-    if (!cache_write_result)
+    void complete(this WritePipeline &self, const Completion &completion)
     {
-        log_err("Failed to write into cache file, save-as may not work as expected.");
+        --self.m_pending;
+        self.m_pending_bytes -= completion.footprint;
+        ++(completion.written ? self.m_written : self.m_failed);
     }
-}
+
+private:
+    // No more completions than pending projects, so the writer never waits for room to report one
+    SpscQueue<Request> m_requests{ max_pending };
+    SpscQueue<Completion> m_completions{ max_pending };
+    DirMaterializer &m_base;
+    // Only touched by the submitting thread
+    std::size_t m_pending = 0;
+    std::size_t m_pending_bytes = 0;
+    std::size_t m_written = 0;
+    std::size_t m_failed = 0;
+    // Last, so that it is joined before the queues are destroyed
+    std::jthread m_writer;
+};
 
 struct CMakeOutput::Impl
 {
@@ -192,112 +1337,382 @@ struct CMakeOutput::Impl
 
     Impl() noexcept {}
 
-    bool ensure_dir_valid_and_exists()
+    void load_options(const std::filesystem::path &directory, std::string_view project)
+    {
+        m_directory = directory;
+        m_cstd = *Args::CMAKE_CSTD;
+        m_cxxstd = *Args::CMAKE_CXXSTD;
+        m_projName = project;
+        m_version = *Args::CMAKE_VERSION;
+    }
+
+    bool update_existing()
     {
-        if (!std::filesystem::exists(m_directory))
+        if (!Args::CMAKE_VERSION.used() && !Args::CMAKE_CSTD.used() && !Args::CMAKE_CXXSTD.used())
+        {
+            log_err("Nothing to update, pass --version, --cstd or --cxxstd or a config that sets them.");
+            return false;
+        }
+        if ((Args::CMAKE_CSTD.used() && !check_standard(SourceLang::C, m_cstd)) ||
+            (Args::CMAKE_CXXSTD.used() && !check_standard(SourceLang::CXX, m_cxxstd)))
+        {
+            return false;
+        }
+
+        auto path = m_directory / "CMakeLists.txt";
+        std::string patched;
         {
-            std::error_code ec;
-            std::filesystem::create_directories(m_directory, ec);
-            if (ec)
+            auto mapped_result = MappedFile::open(path);
+            if (!mapped_result)
+            {
+                log_err("{}", mapped_result.error().msg());
+                return false;
+            }
+
+            std::string_view source = mapped_result.value().text();
+            CMakeTargets targets;
+            if (Args::CMAKE_VERSION.used())
+            {
+                targets.version = m_version;
+            }
+            if (Args::CMAKE_CSTD.used())
             {
-                WithSourceLocation{}.log_err("Fail to create directory \"{}\"", m_directory.string());
+                targets.cstd = m_cstd;
+            }
+            if (Args::CMAKE_CXXSTD.used())
+            {
+                targets.cxxstd = m_cxxstd;
+            }
+
+            auto edits = plan_cmake_edits(source, targets);
+            if (!edits)
+            {
+                log_err("Failed to parse \"{}\", it was left unchanged.", path.string());
                 return false;
             }
+            if (edits->empty())
+            {
+                log_info("\"{}\" is up to date.", path.string());
+                return true;
+            }
+
+            patched = apply_cmake_edits(source, *edits);
         }
-        else if (!std::filesystem::is_directory(m_directory))
+
+        // Replaced atomically, the mapping above must not see the file change underneath it
+        if (!replace_file(path, patched))
         {
-            WithSourceLocation{}.log_err("Not a directory: \"{}\"", m_directory.string());
             return false;
         }
 
+        if (*Args::CMAKE_SHOW)
+        {
+            std::cout << patched;
+        }
         return true;
     }
 
     bool output()
     {
-        m_directory = *Args::CMAKE_WORKDIRECTORY;
-        m_cstd = *Args::CMAKE_CSTD;
-        m_cxxstd = *Args::CMAKE_CXXSTD;
-        m_projName = *Args::CMAKE_PROJECT;
-        m_version = *Args::CMAKE_VERSION;
-
-        if (!ensure_dir_valid_and_exists())
+        if (Args::CMAKE_MANIFEST.given())
         {
-            return false;
+            return output_manifest();
         }
+        return output_project(*Args::CMAKE_WORKDIRECTORY, *Args::CMAKE_PROJECT);
+    }
 
-        auto file_create_result = File::create(m_directory / "CMakeLists.txt", FileMode::write);
-        if (!file_create_result)
+    // Entry directories are relative to the directory given on the command line
+    bool output_manifest()
+    {
+        FT_TRACE_SCOPE("CMakeOutput::output_manifest");
+        const std::string &manifest = *Args::CMAKE_MANIFEST;
+        auto reader_open_result = ManifestReader::open(manifest);
+        if (!reader_open_result)
         {
-            log_err("Failed to create CMakeLists.txt.");
+            log_err("{}", reader_open_result.error().msg());
             return false;
         }
 
-        auto &file = file_create_result.value();
-
-        std::string_view filename;
-        std::string_view src;
-        std::string_view export_command = *Args::CMAKE_EXPORTCMD ? "\nset(CMAKE_EXPORT_COMPILE_COMMANDS ON)\n" : "";
-
-        if (*Args::CMAKE_MAINLANG == "C")
+        auto &reader = reader_open_result.value();
+        std::filesystem::path base = *Args::CMAKE_WORKDIRECTORY;
+        // Each config starts over from the options of the command line and --use-config
+        auto defaults = std::apply([](auto &...args) { return std::tuple{ args... }; }, config_args());
+        YAML::Node cache;
+        KeyTable<YAML::Node> configs;
+        bool cache_loaded = false;
+        // Consecutive entries of the same config reuse the options it set
+        std::string applied;
+        bool applied_found = true;
+        std::size_t generated = 0;
+        std::size_t failed = 0;
+        // Recorded once every project is written, under a single lock of the registry
+        OutputRecords records;
+        std::filesystem::path outputs_path;
+        if (*Args::CMAKE_WATCHABLE && !*Args::CMAKE_UPDATE)
+        {
+            if (auto dir = cache_dir(); !dir.empty())
+            {
+                outputs_path = dir / outputs_file_name;
+            }
+        }
+        // Updates patch files in place and are not worth overlapping. Projects are written below a single handle of
+        // the base directory, instead of resolving their whole path each
+        std::optional<DirMaterializer> base_dirs;
+        std::optional<WritePipeline> pipeline;
+        if (!*Args::CMAKE_UPDATE)
         {
-            filename = c_fileName;
-            src = c_example;
+            auto dirs_open_result = DirMaterializer::open(base);
+            if (!dirs_open_result)
+            {
+                log_err("{}", dirs_open_result.error().msg());
+                return false;
+            }
+            base_dirs.emplace(std::move(dirs_open_result.value()));
+            pipeline.emplace(*base_dirs);
         }
-        else
+
+        ManifestEntry entry;
+        while (reader.next(entry))
         {
-            filename = cxx_fileName;
-            if (m_cxxstd >= 23)
+            if (entry.config != applied)
+            {
+                config_args() = defaults;
+                applied = entry.config;
+                applied_found = true;
+                if (!applied.empty())
+                {
+                    if (!cache_loaded)
+                    {
+                        if (auto dir = cache_dir(); !dir.empty())
+                        {
+                            cache = read_cache(dir / "cmake.yaml");
+                            configs = index_map(cache);
+                        }
+                        cache_loaded = true;
+                    }
+
+                    YAML::Node *config = configs.find(applied);
+                    metrics::count_config(applied, config);
+                    applied_found = config != nullptr;
+                    if (config)
+                    {
+                        CacheIO includer{ *config };
+                        for_each_config_arg([&](auto &arg) { includer.do_include(arg); });
+                    }
+                    else
+                    {
+                        log_err("Unknown config \"{}\" on line {} of \"{}\", its entries are skipped.",
+                                applied,
+                                reader.line(),
+                                manifest);
+                    }
+                }
+            }
+
+            std::string_view project = entry.project.empty() ? *Args::CMAKE_PROJECT : entry.project;
+            if (!applied_found)
+            {
+                ++failed;
+                continue;
+            }
+
+            std::string_view config = applied.empty() ? std::string_view{ *Args::CMAKE_USECONFIG } : applied;
+            if (!outputs_path.empty() && !config.empty())
+            {
+                records.emplace_back(output_directory(base / entry.directory), output_record(config, project));
+            }
+
+            if (!pipeline)
             {
-                src = cxx23_example;
+                ++(output_project(base / entry.directory, project) ? generated : failed);
             }
             else
             {
-                src = cxx_example;
+                load_options(entry.directory, project);
+                if (auto rendered = render_project())
+                {
+                    pipeline->submit(std::move(*rendered));
+                }
+                else
+                {
+                    ++failed;
+                }
             }
         }
+        // The cacher saves --save-as from Args once generation is done
+        config_args() = defaults;
 
-        std::string output =
-            std::format(cmake_template, m_version, m_cstd, m_cxxstd, m_projName, filename, export_command);
+        if (pipeline)
+        {
+            pipeline->finish();
+            generated += pipeline->written();
+            failed += pipeline->failed();
+        }
+        if (!outputs_path.empty())
+        {
+            record_outputs(outputs_path, records);
+        }
 
-        auto output_write_result = file.write(output);
-        if (!output_write_result)
+        if (reader.failed())
         {
-            log_err("Failed to write into CMakeLists.txt.");
-            return false;
+            log_err("Line {} of \"{}\" is malformed, expected directory[,project[,config]] without quotes.",
+                    reader.line(),
+                    manifest);
         }
+        log_info("Generated {} projects from \"{}\", {} failed.", generated, manifest, failed);
+        return failed == 0 && !reader.failed();
+    }
 
-        if (*Args::CMAKE_SHOW)
+    bool output_project(const std::filesystem::path &directory, std::string_view project)
+    {
+        FT_TRACE_SCOPE("CMakeOutput::output");
+        metrics::ScopedTimer timer{ metrics::Timer::generate };
+        load_options(directory, project);
+        if (*Args::CMAKE_UPDATE)
         {
-            std::ignore = file.flush_to(std::cout);
+            return update_existing();
         }
 
-        if (*Args::CMAKE_GENSRC)
+        auto rendered = render_project();
+        return rendered && write_project(*rendered);
+    }
+
+    // Everything that depends on Args, for the options loaded last
+    std::optional<RenderedProject> render_project()
+    {
+        FT_TRACE_SCOPE("render_project");
+        RenderedProject rendered;
+        rendered.started = std::chrono::steady_clock::now();
+        rendered.directory = m_directory;
+
+        // Cached configs bypass argparse's choices, so the mode is checked here
+        auto header_mode = parse_header_mode(*Args::CMAKE_HEADERMODE);
+        if (!header_mode)
+        {
+            log_err("Unknown header mode \"{}\", expected include, pch or module.", *Args::CMAKE_HEADERMODE);
+            return std::nullopt;
+        }
+
+        const BuildProfile *profile = find_build_profile(*Args::CMAKE_BUILDPROFILE);
+        if (!profile)
+        {
+            log_err("Unknown build profile \"{}\", expected none, dev or release.", *Args::CMAKE_BUILDPROFILE);
+            return std::nullopt;
+        }
+
+        if (!check_standard(SourceLang::C, m_cstd) || !check_standard(SourceLang::CXX, m_cxxstd))
         {
-            auto src_path = m_directory / "src";
-            if (!std::filesystem::create_directories(src_path))
+            return std::nullopt;
+        }
+
+        std::string_view required_version;
+        auto require_version = [&](bool needed, std::string_view version)
+        {
+            if (needed && version_less(required_version, version))
             {
-                log_err("Failed to create directories for source files.");
-                return true;
+                required_version = version;
             }
+        };
+        require_version(*header_mode != HeaderMode::include, pch_min_version);
+        require_version(profile != &build_profiles.front(), profile_min_version);
+        require_version(*Args::CMAKE_WITHBENCH || *Args::CMAKE_WITHPROFILING, fetch_content_min_version);
 
-            auto src_create_result = File::create(src_path / filename, FileMode::write);
-            if (!src_create_result)
+        auto [min_version, max_version] = split_version_range(m_version);
+        if (!required_version.empty() && version_less(min_version, required_version))
+        {
+            log_info("The requested options need CMake {}, raising the minimum version.", required_version);
+            // A policy max is kept, and raised along if it would fall behind
+            std::string raised{ required_version };
+            if (!max_version.empty())
             {
-                log_err("Failed to create source files, you may have empty directories.");
-                return true;
+                raised += "...";
+                raised += version_less(max_version, required_version) ? required_version : max_version;
             }
+            m_version = std::move(raised);
+        }
+
+        std::string_view export_command = *Args::CMAKE_EXPORTCMD ? export_commands_block : "";
+
+        SourceTemplate source = *Args::CMAKE_MAINLANG == "C" ? *source_template(SourceLang::C, m_cstd)
+                                                              : *source_template(SourceLang::CXX, m_cxxstd);
+        std::string_view filename = source.filename;
+        std::string_view src = source.content;
+
+        // Sources without an import std variant can only use the precompiled header
+        bool import_std = *header_mode == HeaderMode::module && !source.modular.empty();
+        if (import_std)
+        {
+            src = source.modular;
+        }
 
-            auto &src_file = src_create_result.value();
-            auto src_write_result = src_file.write(src);
-            if (!src_write_result)
+        {
+            metrics::ScopedTimer render_timer{ metrics::Timer::render };
+            auto fingerprint = template_fingerprint();
+            PartialTemplate *specialized = specialized_templates().find(fingerprint);
+            metrics::add(specialized ? metrics::Counter::template_cache_hits
+                                     : metrics::Counter::template_cache_misses);
+            if (!specialized)
             {
-                log_err("Failed to write into source, you may have an empty source file.");
+                std::string_view pre_project;
+                std::string header_block;
+                if (import_std)
+                {
+                    pre_project = import_std_gate;
+                    header_block = std::format(import_std_template, source.headers);
+                }
+                else if (*header_mode != HeaderMode::include)
+                {
+                    header_block = std::format(pch_template, source.headers);
+                }
+
+                std::string cstd = std::to_string(m_cstd);
+                std::string cxxstd = std::to_string(m_cxxstd);
+                std::string profile_block = build_profile_block(*profile, *Args::CMAKE_MAINLANG);
+                std::array<std::optional<std::string_view>, cmake_template_slots> config_values{
+                    m_version,
+                    cstd,
+                    cxxstd,
+                    std::nullopt,
+                    filename,
+                    export_command,
+                    pre_project,
+                    header_block,
+                    profile_block,
+                    *Args::CMAKE_WITHBENCH ? bench_subdirectory : "",
+                    *Args::CMAKE_WITHPROFILING ? profiling_block : "",
+                    *Args::CMAKE_PRESETS ? pgo_training_block : "",
+                };
+
+                specialized = &specialized_templates().insert_or_assign(
+                    fingerprint, PartialTemplate::parse(cmake_template)->bind(config_values));
             }
-            return true;
+
+            std::array<std::string_view, cmake_template_slots> project_values{};
+            project_values[project_slot] = m_projName;
+            rendered.cmake_lists = specialized->render(project_values);
         }
+        rendered.show = *Args::CMAKE_SHOW;
 
-        return true;
+        // The presets only refer to ${sourceDir}, so the embedded file is written as is
+        if (*Args::CMAKE_PRESETS)
+        {
+            rendered.files.emplace_back("CMakePresets.json", embedded::cmake_CMakePresets_json);
+        }
+        if (*Args::CMAKE_WITHBENCH)
+        {
+            rendered.files.emplace_back("bench/CMakeLists.txt", embedded::bench_CMakeLists_txt);
+            rendered.files.emplace_back("bench/bench.cpp", source.bench);
+        }
+        if (*Args::CMAKE_WITHPROFILING)
+        {
+            rendered.files.emplace_back("src/profile.h", source.profile);
+        }
+        if (*Args::CMAKE_GENSRC)
+        {
+            rendered.source_name = filename;
+            rendered.source = src;
+        }
+        return rendered;
     }
 };
 
@@ -312,4 +1727,135 @@ CMakeOutput::CMakeOutput() noexcept
 }
 
 CMakeOutput::~CMakeOutput() {}
+
+// Changes with the options of a config, but not with the specialized template cached along with them
+static std::uint64_t config_hash(const YAML::Node &config)
+{
+    KeyTable<YAML::Node> options = index_map(config);
+    std::uint64_t hash = 0;
+    auto mix = [&](std::string_view value) { hash = (hash ^ fnv1a(value)) * 0x100000001b3ull; };
+    for_each_config_arg(
+        [&](auto &arg)
+        {
+            if (YAML::Node *option = options.find(arg.hash(), arg.name()))
+            {
+                mix(arg.name());
+                mix(YAML::Dump(*option));
+            }
+        });
+    return hash;
+}
+
+CMakeWatcher::CMakeWatcher(std::chrono::milliseconds debounce) noexcept
+    : m_debounce(debounce)
+{
+}
+
+bool CMakeWatcher::run()
+{
+    auto dir = cache_dir();
+    if (dir.empty())
+    {
+        log_err("Failed to locate cache, there is nothing to watch.");
+        return false;
+    }
+
+    auto cache_path = dir / "cmake.yaml";
+    auto watcher_create_result = FileWatcher::create(cache_path);
+    if (!watcher_create_result)
+    {
+        log_err("{}", watcher_create_result.error().msg());
+        return false;
+    }
+
+    auto &watcher = watcher_create_result.value();
+    KeyTable<std::uint64_t> seen;
+    for (auto &&entry : read_cache(cache_path))
+    {
+        seen.insert_or_assign(entry.first.Scalar(), config_hash(entry.second));
+    }
+
+    log_info("Watching \"{}\" for config changes.", cache_path.string());
+    while (watcher.wait(m_debounce))
+    {
+        // Every config changed since the last pass is handled in this one
+        YAML::Node cache = read_cache(cache_path);
+        KeyTable<YAML::Node> changed;
+        for (auto &&entry : cache)
+        {
+            std::uint64_t hash = config_hash(entry.second);
+            std::uint64_t *last = seen.find(entry.first.Scalar());
+            if (!last || *last != hash)
+            {
+                changed.insert_or_assign(entry.first.Scalar(), entry.second);
+                seen.insert_or_assign(entry.first.Scalar(), hash);
+            }
+        }
+
+        if (changed.size() != 0)
+        {
+            regenerate(dir / outputs_file_name, changed);
+        }
+    }
+
+    log_err("Stopped watching \"{}\".", cache_path.string());
+    return false;
+}
+
+void CMakeWatcher::regenerate(const std::filesystem::path &outputs_path, KeyTable<YAML::Node> &changed)
+{
+    YAML::Node outputs;
+    try
+    {
+        outputs = YAML::Load(read_text(outputs_path));
+    }
+    catch (const YAML::Exception &)
+    {
+        log_err("Output registry corrupted, nothing was regenerated.");
+        return;
+    }
+
+    for (auto &&output : outputs)
+    {
+        std::string directory;
+        std::string cfg;
+        try
+        {
+            directory = output.first.as<std::string>();
+            cfg = output.second["config"].as<std::string>();
+        }
+        catch (const YAML::Exception &)
+        {
+            continue;
+        }
+
+        YAML::Node *config = changed.find(cfg);
+        if (!config)
+        {
+            continue;
+        }
+
+        // Options given on the command line override the config, so only the others follow it
+        YAML::Node recorded = output.second["args"];
+        YAML::Node followed = YAML::Clone(*config);
+        for (auto &&name : output.second["given"])
+        {
+            followed.remove(name.Scalar());
+        }
+
+        CacheIO restorer{ recorded };
+        for_each_config_arg([&](auto &arg) { restorer.do_include(arg); });
+        restorer.do_include(Args::CMAKE_PROJECT);
+        restorer.do_include(Args::CMAKE_GENSRC);
+
+        CacheIO includer{ followed };
+        for_each_config_arg([&](auto &arg) { includer.do_include(arg); });
+
+        Args::CMAKE_WORKDIRECTORY.assign(directory);
+        if (CMakeOutput{}.output())
+        {
+            log_info("Regenerated \"{}\" from config \"{}\".", directory, cfg);
+        }
+    }
+}
 } // namespace ft
\ No newline at end of file
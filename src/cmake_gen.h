@@ -1,9 +1,12 @@
 #pragma once
+#include <chrono>
+#include <filesystem>
 #include <memory>
 
-#include <argparse/argparse.hpp>
 #include <yaml-cpp/yaml.h>
 
+#include "key_table.h"
+
 namespace ft
 {
 class CMakeOutput
@@ -23,13 +26,35 @@ private:
 class CMakeCacher
 {
 public:
-    CMakeCacher(argparse::ArgumentParser &parser) noexcept;
+    CMakeCacher() noexcept;
 
     void update();
 
 private:
-    argparse::ArgumentParser &r_parser;
+    bool load_cache();
+
+    // Remembers which directory was generated from the used config, so that `watch` can regenerate it
+    void record_output();
+
+private:
     YAML::Node m_cache;
+    KeyTable<YAML::Node> m_configs;
     std::filesystem::path m_cachePath;
 };
+
+// Regenerates the directories recorded for a config whenever that config changes in the cache
+class CMakeWatcher
+{
+public:
+    CMakeWatcher(std::chrono::milliseconds debounce) noexcept;
+
+    // Only returns once the cache can no longer be watched
+    bool run();
+
+private:
+    void regenerate(const std::filesystem::path &outputs_path, KeyTable<YAML::Node> &changed);
+
+private:
+    std::chrono::milliseconds m_debounce;
+};
 } // namespace ft
\ No newline at end of file
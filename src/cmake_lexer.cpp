@@ -0,0 +1,246 @@
+#include "cmake_lexer.h"
+
+#include <cstring>
+
+namespace ft
+{
+namespace
+{
+    constexpr bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    constexpr bool is_identifier_start(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    constexpr bool is_identifier(char c) { return is_identifier_start(c) || (c >= '0' && c <= '9'); }
+
+    // Characters that end an unquoted argument
+    constexpr bool is_unquoted_end(char c) { return is_space(c) || c == '(' || c == ')' || c == '#' || c == '"'; }
+
+    std::size_t find_char(std::string_view text, std::size_t from, char c)
+    {
+        if (from >= text.size())
+        {
+            return std::string_view::npos;
+        }
+
+        auto *found = static_cast<const char *>(std::memchr(text.data() + from, c, text.size() - from));
+        return found ? static_cast<std::size_t>(found - text.data()) : std::string_view::npos;
+    }
+} // namespace
+
+bool CMakeLexer::fail(this CMakeLexer &self)
+{
+    self.m_failed = true;
+    self.m_pos = self.m_source.size();
+    return false;
+}
+
+// Expects m_pos at '[', leaves it after the closing bracket. False if it does not open a bracket
+bool CMakeLexer::skip_bracket(this CMakeLexer &self, std::string_view &content)
+{
+    std::string_view src = self.m_source;
+    std::size_t pos = self.m_pos + 1;
+    std::size_t level = 0;
+    while (pos < src.size() && src[pos] == '=')
+    {
+        ++pos;
+        ++level;
+    }
+    if (pos >= src.size() || src[pos] != '[')
+    {
+        return false;
+    }
+
+    std::size_t begin = pos + 1;
+    for (std::size_t close = find_char(src, begin, ']'); close != std::string_view::npos;
+         close = find_char(src, close + 1, ']'))
+    {
+        std::size_t end = close + 1;
+        while (end < src.size() && src[end] == '=' && end - close - 1 < level)
+        {
+            ++end;
+        }
+        if (end - close - 1 == level && end < src.size() && src[end] == ']')
+        {
+            content = src.substr(begin, close - begin);
+            self.m_pos = end + 1;
+            return true;
+        }
+    }
+
+    return self.fail();
+}
+
+// Expects m_pos at '#', leaves it at the end of the comment
+bool CMakeLexer::skip_comment(this CMakeLexer &self)
+{
+    ++self.m_pos;
+    if (self.m_pos < self.m_source.size() && self.m_source[self.m_pos] == '[')
+    {
+        std::string_view content;
+        if (self.skip_bracket(content))
+        {
+            return true;
+        }
+        if (self.m_failed)
+        {
+            return false;
+        }
+    }
+
+    std::size_t newline = find_char(self.m_source, self.m_pos, '\n');
+    self.m_pos = newline == std::string_view::npos ? self.m_source.size() : newline + 1;
+    return true;
+}
+
+bool CMakeLexer::lex_quoted(this CMakeLexer &self, CMakeArgument &argument)
+{
+    std::string_view src = self.m_source;
+    std::size_t begin = self.m_pos;
+    for (std::size_t quote = find_char(src, begin + 1, '"'); quote != std::string_view::npos;
+         quote = find_char(src, quote + 1, '"'))
+    {
+        // An odd number of backslashes escapes the quote
+        std::size_t backslashes = 0;
+        while (src[quote - 1 - backslashes] == '\\')
+        {
+            ++backslashes;
+        }
+        if (backslashes % 2 == 0)
+        {
+            argument = { src.substr(begin, quote + 1 - begin),
+                         src.substr(begin + 1, quote - begin - 1),
+                         CMakeArgument::Kind::quoted };
+            self.m_pos = quote + 1;
+            return true;
+        }
+    }
+
+    return self.fail();
+}
+
+void CMakeLexer::lex_unquoted(this CMakeLexer &self, CMakeArgument &argument)
+{
+    std::string_view src = self.m_source;
+    std::size_t begin = self.m_pos;
+    std::size_t pos = begin;
+    while (pos < src.size() && !is_unquoted_end(src[pos]))
+    {
+        pos += src[pos] == '\\' && pos + 1 < src.size() ? 2 : 1;
+    }
+
+    argument = { src.substr(begin, pos - begin), src.substr(begin, pos - begin), CMakeArgument::Kind::unquoted };
+    self.m_pos = pos;
+}
+
+bool CMakeLexer::next(this CMakeLexer &self, CMakeCommand &command)
+{
+    std::string_view src = self.m_source;
+    command.arguments.clear();
+
+    while (self.m_pos < src.size())
+    {
+        char c = src[self.m_pos];
+        if (is_space(c))
+        {
+            ++self.m_pos;
+        }
+        else if (c == '#')
+        {
+            if (!self.skip_comment())
+            {
+                return false;
+            }
+        }
+        else if (is_identifier_start(c))
+        {
+            break;
+        }
+        else
+        {
+            return self.fail();
+        }
+    }
+    if (self.m_pos >= src.size())
+    {
+        return false;
+    }
+
+    std::size_t begin = self.m_pos;
+    while (self.m_pos < src.size() && is_identifier(src[self.m_pos]))
+    {
+        ++self.m_pos;
+    }
+    command.name = src.substr(begin, self.m_pos - begin);
+
+    while (self.m_pos < src.size() && (src[self.m_pos] == ' ' || src[self.m_pos] == '\t'))
+    {
+        ++self.m_pos;
+    }
+    if (self.m_pos >= src.size() || src[self.m_pos] != '(')
+    {
+        return self.fail();
+    }
+    ++self.m_pos;
+
+    std::size_t depth = 1;
+    while (self.m_pos < src.size())
+    {
+        char c = src[self.m_pos];
+        if (is_space(c))
+        {
+            ++self.m_pos;
+        }
+        else if (c == '(')
+        {
+            ++depth;
+            ++self.m_pos;
+        }
+        else if (c == ')')
+        {
+            ++self.m_pos;
+            if (--depth == 0)
+            {
+                command.text = src.substr(begin, self.m_pos - begin);
+                return true;
+            }
+        }
+        else if (c == '#')
+        {
+            if (!self.skip_comment())
+            {
+                return false;
+            }
+        }
+        else if (c == '"')
+        {
+            if (!self.lex_quoted(command.arguments.emplace_back()))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            std::string_view content;
+            std::size_t arg_begin = self.m_pos;
+            if (c == '[' && self.skip_bracket(content))
+            {
+                command.arguments.push_back(
+                    { src.substr(arg_begin, self.m_pos - arg_begin), content, CMakeArgument::Kind::bracket });
+            }
+            else if (self.m_failed)
+            {
+                return false;
+            }
+            else
+            {
+                self.lex_unquoted(command.arguments.emplace_back());
+            }
+        }
+    }
+
+    return self.fail();
+}
+} // namespace ft
\ No newline at end of file
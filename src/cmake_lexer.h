@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace ft
+{
+struct CMakeArgument
+{
+    enum class Kind
+    {
+        unquoted,
+        quoted,
+        bracket
+    };
+
+    // Exactly as written, including quotes or brackets
+    std::string_view text;
+    // Content without quotes or brackets, escape sequences are left as written
+    std::string_view value;
+    Kind kind;
+};
+
+struct CMakeCommand
+{
+    std::string_view name;
+    // From the name through the closing parenthesis
+    std::string_view text;
+    // Arguments of nested parentheses are flattened into the list, the parentheses themselves are skipped
+    std::vector<CMakeArgument> arguments;
+};
+
+// Splits CMake source into command invocations. Comments, quoted and bracket arguments are skipped with memchr,
+// the rest is scanned a byte at a time only where a token boundary can occur. All views point into the source
+class CMakeLexer
+{
+public:
+    explicit CMakeLexer(std::string_view source)
+        : m_source(source)
+    {
+    }
+
+    // Reuses `command`'s argument storage. False at the end of the source or on a syntax error
+    bool next(this CMakeLexer &self, CMakeCommand &command);
+
+    bool failed(this const CMakeLexer &self) { return self.m_failed; }
+
+    // Offset of a view returned by the lexer into the source
+    std::size_t offset_of(this const CMakeLexer &self, std::string_view view)
+    {
+        return static_cast<std::size_t>(view.data() - self.m_source.data());
+    }
+
+private:
+    bool skip_comment(this CMakeLexer &self);
+    bool skip_bracket(this CMakeLexer &self, std::string_view &content);
+    bool lex_quoted(this CMakeLexer &self, CMakeArgument &argument);
+    void lex_unquoted(this CMakeLexer &self, CMakeArgument &argument);
+    bool fail(this CMakeLexer &self);
+
+private:
+    std::string_view m_source;
+    std::size_t m_pos = 0;
+    bool m_failed = false;
+};
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "dir_materializer.h"
+
+#include <span>
+#include <string>
+#include <system_error>
+
+namespace ft
+{
+// Requests name the same directory the same way, so that they share a single entry
+static std::filesystem::path normalize(const std::filesystem::path &relative)
+{
+    auto normal = relative.relative_path().lexically_normal();
+    if (normal == ".")
+    {
+        return {};
+    }
+    if (!normal.empty() && !normal.has_filename())
+    {
+        return normal.parent_path();
+    }
+    return normal;
+}
+
+FileOpResult<DirMaterializer> DirMaterializer::open(const std::filesystem::path &root)
+{
+    native::Handle handle = native::open_dir(root);
+    if (handle == native::invalid_handle)
+    {
+        std::error_code ec;
+        if (std::filesystem::exists(root, ec) && !std::filesystem::is_directory(root, ec))
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::not_a_directory, root } };
+        }
+
+        // Only the root may be deep and absolute, a single call is fine for it
+        std::filesystem::create_directories(root, ec);
+        handle = native::open_dir(root);
+        if (handle == native::invalid_handle)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::dir_create_failed, root } };
+        }
+    }
+
+    return DirMaterializer{ Dir{ handle, root } };
+}
+
+DirMaterializer::DirMaterializer(Dir root)
+{
+    m_handles.push_back(root.handle);
+    m_dirs.insert_or_assign("", std::move(root));
+}
+
+DirMaterializer::~DirMaterializer()
+{
+    for (auto handle : m_handles)
+    {
+        native::close(handle);
+    }
+}
+
+FileOpResult<DirMaterializer::Dir *> DirMaterializer::dir(this DirMaterializer &self,
+                                                          const std::filesystem::path &relative)
+{
+    auto key = relative.generic_string();
+    if (Dir *found = self.m_dirs.find(key))
+    {
+        return found;
+    }
+
+    auto parent_result = self.dir(relative.parent_path());
+    if (!parent_result)
+    {
+        return std::unexpected{ parent_result.error() };
+    }
+
+    // Copied, inserting below may move the parent's slot
+    Dir parent = *parent_result.value();
+    auto name = relative.filename();
+    auto handle_result = open_child(parent, name);
+    if (!handle_result)
+    {
+        return std::unexpected{ handle_result.error() };
+    }
+
+    self.m_handles.push_back(handle_result.value());
+    return &self.m_dirs.insert_or_assign(key, Dir{ handle_result.value(), parent.path / name });
+}
+
+FileOpResult<native::Handle> DirMaterializer::open_child(const Dir &parent, const std::filesystem::path &name)
+{
+    // Opening first saves the mkdir for directories that already exist
+    native::Handle handle = native::open_dir_at(parent.handle, parent.path, name);
+    if (handle == native::invalid_handle)
+    {
+        if (!native::make_dir_at(parent.handle, parent.path, name))
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::dir_create_failed, parent.path / name } };
+        }
+
+        handle = native::open_dir_at(parent.handle, parent.path, name);
+        if (handle == native::invalid_handle)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::not_a_directory, parent.path / name } };
+        }
+    }
+    return handle;
+}
+
+FileOpResult<DirMaterializer> DirMaterializer::subdir(this DirMaterializer &self, const std::filesystem::path &relative)
+{
+    if (relative.has_root_path())
+    {
+        return open(relative);
+    }
+
+    auto normal = normalize(relative);
+    if (normal.empty())
+    {
+        return open(self.m_dirs.find("")->path);
+    }
+
+    auto parent_result = self.dir(normal.parent_path());
+    if (!parent_result)
+    {
+        return std::unexpected{ parent_result.error() };
+    }
+
+    const Dir &parent = *parent_result.value();
+    auto name = normal.filename();
+    auto handle_result = open_child(parent, name);
+    if (!handle_result)
+    {
+        return std::unexpected{ handle_result.error() };
+    }
+    return DirMaterializer{ Dir{ handle_result.value(), parent.path / name } };
+}
+
+FileOpResult<> DirMaterializer::ensure_dir(this DirMaterializer &self, const std::filesystem::path &relative)
+{
+    auto dir_result = self.dir(normalize(relative));
+    if (!dir_result)
+    {
+        return std::unexpected{ dir_result.error() };
+    }
+    return {};
+}
+
+FileOpResult<File> DirMaterializer::create_file(this DirMaterializer &self,
+                                                const std::filesystem::path &relative,
+                                                bool use_buffer)
+{
+    auto normal = normalize(relative);
+    auto dir_result = self.dir(normal.parent_path());
+    if (!dir_result)
+    {
+        return std::unexpected{ dir_result.error() };
+    }
+
+    const Dir &parent = *dir_result.value();
+    auto name = normal.filename();
+    return File::adopt(native::open_at(parent.handle, parent.path, name, true),
+                       parent.path / name,
+                       FileMode::write,
+                       use_buffer);
+}
+
+FileOpResult<bool> DirMaterializer::write_if_changed(this DirMaterializer &self,
+                                                    const std::filesystem::path &relative,
+                                                    std::string_view content)
+{
+    auto normal = normalize(relative);
+    auto dir_result = self.dir(normal.parent_path());
+    if (!dir_result)
+    {
+        return std::unexpected{ dir_result.error() };
+    }
+
+    const Dir &parent = *dir_result.value();
+    auto name = normal.filename();
+    auto path = parent.path / name;
+
+    // Files of another size differ anyway, only same-sized ones are read back
+    native::Handle existing = native::open_at(parent.handle, parent.path, name, false);
+    if (existing != native::invalid_handle)
+    {
+        bool same = false;
+        if (auto size = native::size(existing); size && *size == content.size())
+        {
+            std::string current(content.size(), '\0');
+            same = native::read_all(existing, std::as_writable_bytes(std::span{ current })) && current == content;
+        }
+        native::close(existing);
+        if (same)
+        {
+            return false;
+        }
+    }
+
+    auto file_create_result = File::adopt(native::open_at(parent.handle, parent.path, name, true), path, FileMode::write);
+    if (!file_create_result)
+    {
+        return std::unexpected{ file_create_result.error() };
+    }
+
+    auto &file = file_create_result.value();
+    if (auto write_result = file.write(content); !write_result)
+    {
+        return std::unexpected{ write_result.error() };
+    }
+    if (auto close_result = file.close(); !close_result)
+    {
+        return std::unexpected{ close_result.error() };
+    }
+    return true;
+}
+} // namespace ft
\ No newline at end of file
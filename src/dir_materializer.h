@@ -0,0 +1,72 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "file_io.hpp"
+#include "key_table.h"
+#include "native_file.h"
+
+namespace ft
+{
+// Creates directories and files below a root directory. Each directory is opened once and stays open, children
+// are created relative to their parent's handle, and directories seen before cost no system calls at all
+class DirMaterializer
+{
+public:
+    // Opens the root, creating it first if it does not exist
+    static FileOpResult<DirMaterializer> open(const std::filesystem::path &root);
+
+public:
+    DirMaterializer(DirMaterializer &&another) noexcept
+        : m_dirs(std::move(another.m_dirs))
+        , m_handles(std::exchange(another.m_handles, {}))
+    {
+    }
+    DirMaterializer(const DirMaterializer &) = delete;
+
+    DirMaterializer &operator=(const DirMaterializer &) = delete;
+    DirMaterializer &operator=(DirMaterializer &&) = delete;
+
+    ~DirMaterializer();
+
+    // Materializer rooted at `relative`, created with its missing parents if needed. Only the parents stay open in
+    // this one, so that opening many sibling roots does not pile up their handles
+    FileOpResult<DirMaterializer> subdir(this DirMaterializer &self, const std::filesystem::path &relative);
+
+    // Creates `relative` and its missing parents below the root
+    FileOpResult<> ensure_dir(this DirMaterializer &self, const std::filesystem::path &relative);
+
+    // Creates or truncates the file at `relative`, creating its parent directories first
+    FileOpResult<File> create_file(this DirMaterializer &self,
+                                   const std::filesystem::path &relative,
+                                   bool use_buffer = true);
+
+    // Leaves the file, and so its modification time, alone when it already holds `content`. True if it was written
+    FileOpResult<bool> write_if_changed(this DirMaterializer &self,
+                                        const std::filesystem::path &relative,
+                                        std::string_view content);
+
+private:
+    struct Dir
+    {
+        native::Handle handle = native::invalid_handle;
+        std::filesystem::path path;
+    };
+
+    DirMaterializer(Dir root);
+
+    // Opens `name` below `parent`, creating it first if it does not exist
+    static FileOpResult<native::Handle> open_child(const Dir &parent, const std::filesystem::path &name);
+
+    // Pointers are invalidated by the next lookup of an unknown directory
+    FileOpResult<Dir *> dir(this DirMaterializer &self, const std::filesystem::path &relative);
+
+private:
+    // Keyed by the generic form of the path relative to the root, the root itself is ""
+    KeyTable<Dir> m_dirs;
+    std::vector<native::Handle> m_handles;
+};
+} // namespace ft
\ No newline at end of file
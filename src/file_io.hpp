@@ -1,19 +1,30 @@
 #pragma once
 
-#include <concepts>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
-#include <cstdio>
+#include <cstring>
 #include <format>
 #include <memory>
+#include <optional>
+#include <ranges>
 #include <expected>
 #include <concepts>
 #include <ostream>
 #include <system_error>
-#include <variant>
 #include <vector>
 #include <string>
 #include <span>
+#include <utility>
+
+#include "checksum.h"
+#include "metrics.h"
+#include "trace.h"
+#include "native_file.h"
+#include "serial.hpp"
 
 #ifdef FT_DEBUG
 #include <source_location>
@@ -22,54 +33,38 @@
 namespace ft
 {
 
+// Serializes in place into a caller-provided buffer of serialized_size() bytes, which avoids the
+// intermediate vector returned by serialize()
+template <typename T>
+concept IntoSerializable = requires(const std::remove_cvref_t<T> obj, std::span<std::byte> v) {
+    { obj.serialized_size() } -> std::convertible_to<std::size_t>;
+    obj.serialize_into(v);
+};
+
 template <typename T>
 concept ManSerializable = requires(std::remove_cvref_t<T> obj, std::span<std::byte> v) {
-    { obj.serialize() } -> std::convertible_to<std::vector<std::byte>>;
+    requires IntoSerializable<T> || requires {
+        { obj.serialize() } -> std::convertible_to<std::vector<std::byte>>;
+    };
     obj.deserialize(v);
 };
 
+// Pointers and views such as std::span are trivially copyable too, but their bytes are an address, not the data
+template <typename T>
+concept TriviallySerializable =
+    std::is_trivially_copyable_v<std::remove_cvref_t<T>> && !std::is_pointer_v<std::remove_cvref_t<T>> &&
+    !std::ranges::borrowed_range<std::remove_cvref_t<T>>;
+
 template <typename T>
 concept Printable = std::convertible_to<std::remove_cvref_t<T>, std::string_view>;
 
 template <typename T>
-concept Serializable = ManSerializable<T> || std::is_trivially_copyable_v<std::remove_cvref_t<T>>;
+concept Serializable = ManSerializable<T> || TriviallySerializable<T>;
 
 template <typename T>
 concept GeneralSerializable = Serializable<T> || Printable<T>;
 
-namespace detail
-{
-    template <typename T>
-    concept FileOpErrReq = requires(T err) {
-        { err.msg() } -> std::convertible_to<std::string>;
-    };
-
-    template <typename... Ts>
-        requires(FileOpErrReq<Ts> && ...)
-    using FileOpErrVar = std::variant<Ts...>;
-
-    struct FileOpErrBase
-    {
-        std::filesystem::path file;
-#ifdef FT_DEBUG
-        std::source_location loc = std::source_location::current();
-#endif
-
-        FileOpErrBase(const std::filesystem::path &f)
-            : file(f)
-        {
-        }
-    };
-
-    template <typename T>
-    struct BasicFileOpErr : FileOpErrBase
-    {
-        std::string msg(this T &self) { return std::format(T::fmt_msg, self.file.string()); }
-    };
-
-} // namespace detail
-
-enum class FileMode
+enum class FileMode : std::uint8_t
 {
     read,
     write
@@ -91,89 +86,273 @@ inline constexpr std::string_view stringify_filemode(FileMode mode)
     }
 }
 
-struct FileOpenFailed : detail::BasicFileOpErr<FileOpenFailed>
+enum class FileOpErrCode : std::uint8_t
 {
-    static constexpr std::string_view fmt_msg = R"("{}": Failed to open file.)";
+    open_failed,
+    write_failed,
+    read_failed,
+    lock_failed,
+    checksum_mismatch,
+    mode_inconsistent,
+    dir_create_failed,
+    not_a_directory
 };
 
-struct FileWriteFailed : detail::BasicFileOpErr<FileWriteFailed>
+inline constexpr std::string_view stringify_errcode(FileOpErrCode code)
 {
-    static constexpr std::string_view fmt_msg = R"("{}": Failed to write into file.)";
-};
+    switch (code)
+    {
+    case FileOpErrCode::open_failed:
+        return "open_failed";
+    case FileOpErrCode::write_failed:
+        return "write_failed";
+    case FileOpErrCode::read_failed:
+        return "read_failed";
+    case FileOpErrCode::lock_failed:
+        return "lock_failed";
+    case FileOpErrCode::checksum_mismatch:
+        return "checksum_mismatch";
+    case FileOpErrCode::mode_inconsistent:
+        return "mode_inconsistent";
+    case FileOpErrCode::dir_create_failed:
+        return "dir_create_failed";
+    case FileOpErrCode::not_a_directory:
+        return "not_a_directory";
+    default:
+        return "";
+    }
+}
 
-struct FileReadFailed : detail::BasicFileOpErr<FileReadFailed>
+namespace detail
 {
-    static constexpr std::string_view fmt_msg = R"("{}": Failed to read from file.)";
-};
+    // Paths of the most recent errors raised on the calling thread. Slots are reused, so once warm, recording
+    // a failure only copies characters into an existing string. Ids are unique across threads, an id whose slot
+    // was overwritten or that belongs to another thread is simply not found
+    class ErrPathTable
+    {
+    public:
+        static constexpr std::size_t capacity = 64;
+
+        std::uint32_t record(this ErrPathTable &self, const std::filesystem::path &path)
+        {
+            std::uint32_t id = s_nextId.fetch_add(1, std::memory_order_relaxed);
+            auto &slot = self.m_slots[id % capacity];
+            slot.id = id;
+            slot.path.assign(path.native());
+            return id;
+        }
+
+        const std::filesystem::path::string_type *find(this const ErrPathTable &self, std::uint32_t id)
+        {
+            auto &slot = self.m_slots[id % capacity];
+            return slot.id == id ? &slot.path : nullptr;
+        }
+
+    private:
+        struct Slot
+        {
+            std::uint32_t id = 0;
+            std::filesystem::path::string_type path;
+        };
+
+        static inline std::atomic<std::uint32_t> s_nextId{ 1 };
+
+        std::array<Slot, capacity> m_slots;
+    };
+
+    inline ErrPathTable &err_paths()
+    {
+        thread_local ErrPathTable table;
+        return table;
+    }
+} // namespace detail
 
-struct ModeInconsistent : detail::FileOpErrBase
+// Compact file operation error, the message is only formatted when msg() is called. The path is kept in the
+// raising thread's ErrPathTable, so msg() should be called on that thread before many more errors are raised
+class FileOpErr
 {
-    FileMode mode_active;
-    FileMode mode_requested;
+public:
+#ifdef FT_DEBUG
+    FileOpErr(FileOpErrCode code,
+              const std::filesystem::path &file,
+              FileMode active = FileMode::read,
+              FileMode requested = FileMode::read,
+              std::source_location loc = std::source_location::current())
+        : m_loc(loc)
+        , m_pathId(detail::err_paths().record(file))
+        , m_code(code)
+        , m_active(active)
+        , m_requested(requested)
+    {
+        metrics::count_error(static_cast<std::size_t>(code));
+    }
 
-    std::string msg(this const ModeInconsistent &self)
+    std::source_location location(this const FileOpErr &self) { return self.m_loc; }
+#else
+    FileOpErr(FileOpErrCode code,
+              const std::filesystem::path &file,
+              FileMode active = FileMode::read,
+              FileMode requested = FileMode::read)
+        : m_pathId(detail::err_paths().record(file))
+        , m_code(code)
+        , m_active(active)
+        , m_requested(requested)
     {
-        return std::format(R"("{}": Operation failed requesting mode "{}", while the active mode is "{}")",
-                           self.file.string(),
-                           stringify_filemode(self.mode_requested),
-                           stringify_filemode(self.mode_active));
+        metrics::count_error(static_cast<std::size_t>(code));
     }
-};
+#endif
 
-using FileOpErr = detail::FileOpErrVar<FileOpenFailed, FileWriteFailed, FileReadFailed, ModeInconsistent>;
+    FileOpErrCode code(this const FileOpErr &self) { return self.m_code; }
+
+    std::string msg(this const FileOpErr &self)
+    {
+        std::string file = "<unknown file>";
+        if (auto *path = detail::err_paths().find(self.m_pathId))
+        {
+            file = std::filesystem::path{ *path }.string();
+        }
+
+        switch (self.m_code)
+        {
+        case FileOpErrCode::open_failed:
+            return std::format(R"("{}": Failed to open file.)", file);
+        case FileOpErrCode::write_failed:
+            return std::format(R"("{}": Failed to write into file.)", file);
+        case FileOpErrCode::read_failed:
+            return std::format(R"("{}": Failed to read from file.)", file);
+        case FileOpErrCode::lock_failed:
+            return std::format(R"("{}": Failed to lock file.)", file);
+        case FileOpErrCode::checksum_mismatch:
+            return std::format(R"("{}": Checksum mismatch, file is corrupted.)", file);
+        case FileOpErrCode::dir_create_failed:
+            return std::format(R"("{}": Failed to create directory.)", file);
+        case FileOpErrCode::not_a_directory:
+            return std::format(R"("{}": Not a directory.)", file);
+        case FileOpErrCode::mode_inconsistent:
+            return std::format(R"("{}": Operation failed requesting mode "{}", while the active mode is "{}")",
+                               file,
+                               stringify_filemode(self.m_requested),
+                               stringify_filemode(self.m_active));
+        default:
+            return file;
+        }
+    }
+
+private:
+#ifdef FT_DEBUG
+    std::source_location m_loc;
+#endif
+    std::uint32_t m_pathId;
+    FileOpErrCode m_code;
+    FileMode m_active;
+    FileMode m_requested;
+};
 
 template <typename T = void>
 using FileOpResult = std::expected<T, FileOpErr>;
 
+namespace detail
+{
+    // Errors of flushes run by destructors, which have no other way to report them
+    inline std::vector<FileOpErr> &deferred_errors()
+    {
+        thread_local std::vector<FileOpErr> errors;
+        return errors;
+    }
+
+    // Fixed-size fill source for File::padding, refilled only when the fill byte changes
+    inline std::span<const std::byte, 4096> padding_pattern(std::byte byte)
+    {
+        thread_local std::array<std::byte, 4096> pattern{};
+        thread_local std::byte filled = std::byte{ 0 };
+        if (filled != byte)
+        {
+            pattern.fill(byte);
+            filled = byte;
+        }
+        return pattern;
+    }
+
+    // Staging area for objects that do not fit into the write buffer, reused across calls
+    inline std::vector<std::byte> &serialize_scratch()
+    {
+        thread_local std::vector<std::byte> scratch;
+        return scratch;
+    }
+} // namespace detail
+
 class File
 {
 public:
-    static FileOpResult<File> create(const std::filesystem::path &file_path, FileMode mode, bool use_buffer = false)
+    // Buffered writes are flushed once the buffer would grow past this size, larger writes skip the buffer
+    static constexpr std::size_t default_high_water = 64 * 1024;
+
+    static FileOpResult<File> create(const std::filesystem::path &file_path, FileMode mode, bool use_buffer = true)
     {
+        FT_TRACE_SCOPE("File::create");
         File ret{ file_path, mode, use_buffer };
         if (ret.valid())
         {
-            return std::move(ret);
+            return ret;
+        }
+        else
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::open_failed, file_path } };
+        }
+    }
+
+    // Takes ownership of an already opened handle, e.g. one opened relative to a directory
+    static FileOpResult<File> adopt(native::Handle handle,
+                                    const std::filesystem::path &file_path,
+                                    FileMode mode,
+                                    bool use_buffer = true)
+    {
+        File ret{ handle, file_path, mode, use_buffer };
+        if (ret.valid())
+        {
+            return ret;
         }
         else
         {
-            return std::unexpected{ FileOpenFailed{ file_path } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::open_failed, file_path } };
         }
     }
 
+    // Takes the errors of flushes that failed during destruction on the calling thread
+    static std::vector<FileOpErr> take_deferred_errors() { return std::exchange(detail::deferred_errors(), {}); }
+
 public:
     File(File &&another)
         : m_buf(std::move(another.m_buf))
         , m_path(std::move(another.m_path))
         , m_buf_it(another.m_buf_it)
+        , m_high_water(another.m_high_water)
         , m_use_buffer(another.m_use_buffer)
         , m_valid(another.m_valid)
         , m_mode(another.m_mode)
+        , m_checksum(std::move(another.m_checksum))
+        , m_handle(std::exchange(another.m_handle, native::invalid_handle))
     {
-        m_handle.swap(another.m_handle);
     }
     File(const File &) = delete;
 
     File &operator=(const File &) = delete;
     File &operator=(this File &self, File &&another)
     {
+        self.close_deferred();
         self.m_path = std::move(another.m_path);
-        self.m_handle.swap(another.m_handle);
+        self.m_handle = std::exchange(another.m_handle, native::invalid_handle);
         self.m_buf = std::move(another.m_buf);
         self.m_buf_it = another.m_buf_it;
+        self.m_high_water = another.m_high_water;
         self.m_mode = another.m_mode;
         self.m_valid = another.m_valid;
         self.m_use_buffer = another.m_use_buffer;
+        self.m_checksum = std::move(another.m_checksum);
         return self;
     }
 
-    ~File()
-    {
-        if (m_use_buffer && m_mode == FileMode::write)
-        {
-            std::ignore = flush();
-        }
-    }
+    ~File() { close_deferred(); }
 
     bool valid(this const File &self) { return self.m_valid; }
     operator bool(this File &self) { return self.valid(); }
@@ -181,65 +360,56 @@ public:
     const auto &get_path(this const File &self) { return self.m_path; }
     FileMode get_mode(this const File &self) { return self.m_mode; }
 
+    void set_high_water(this File &self, std::size_t bytes) { self.m_high_water = bytes; }
+
     template <GeneralSerializable T>
     FileOpResult<> write(this File &self, const T &obj)
     {
+        FT_TRACE_SCOPE("File::write");
         if (self.get_mode() != FileMode::write)
         {
-            return std::unexpected{ ModeInconsistent{ self.m_path, self.m_mode, FileMode::write } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
         }
 
-        if constexpr (ManSerializable<T>)
+        if constexpr (IntoSerializable<T>)
         {
-            std::vector<std::byte> buf = obj.serialize();
-            if (self.m_use_buffer)
+            std::size_t size = obj.serialized_size();
+            if (self.m_use_buffer && size < self.m_high_water)
             {
-                self.m_buf.append_range(buf);
-            }
-            else
-            {
-                auto written_count = std::fwrite(buf.data(), buf.size() * sizeof(std::byte), 1, self.m_handle.get());
-                if (written_count != 1)
+                if (self.m_buf.size() + size > self.m_high_water)
                 {
-                    return std::unexpected{ FileWriteFailed{ self.m_path } };
+                    if (auto flush_result = self.flush(); !flush_result)
+                    {
+                        return flush_result;
+                    }
                 }
+
+                std::size_t offset = self.m_buf.size();
+                self.m_buf.resize(offset + size);
+                obj.serialize_into(std::span{ self.m_buf }.subspan(offset));
+                self.track(std::span{ self.m_buf }.subspan(offset));
+                return {};
             }
+
+            auto &scratch = detail::serialize_scratch();
+            scratch.resize(size);
+            obj.serialize_into(std::span{ scratch });
+            return self.write_bytes(scratch);
+        }
+        else if constexpr (ManSerializable<T>)
+        {
+            std::vector<std::byte> buf = obj.serialize();
+            return self.write_bytes(buf);
         }
         else if constexpr (Printable<T>)
         {
             std::string_view str = obj;
-            if (self.m_use_buffer)
-            {
-                self.m_buf.resize(self.m_buf.size() + str.size());
-                std::memcpy(&*(self.m_buf.end() - str.size()), str.data(), str.size());
-            }
-            else
-            {
-                auto written_count = std::fwrite(str.data(), str.size() * sizeof(char), 1, self.m_handle.get());
-                if (written_count != 1)
-                {
-                    return std::unexpected{ FileWriteFailed{ self.m_path } };
-                }
-            }
+            return self.write_bytes(std::as_bytes(std::span{ str }));
         }
         else
         {
-            if (self.m_use_buffer)
-            {
-                self.m_buf.resize(self.m_buf.size() + sizeof(T));
-                std::memcpy(&*(self.m_buf.end() - sizeof(T)), &obj, sizeof(T));
-            }
-            else
-            {
-                auto written_count = std::fwrite(&obj, sizeof(T), 1, self.m_handle.get());
-                if (written_count != 1)
-                {
-                    return std::unexpected{ FileWriteFailed{ self.m_path } };
-                }
-            }
+            return self.write_bytes(std::as_bytes(std::span{ &obj, 1 }));
         }
-
-        return {};
     }
 
     template <GeneralSerializable... Ts>
@@ -253,116 +423,166 @@ public:
         return ret;
     }
 
+    // Writes the bytes the span refers to
+    FileOpResult<> write(this File &self, std::span<const std::byte> bytes)
+    {
+        if (self.get_mode() != FileMode::write)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
+        }
+
+        return self.write_bytes(bytes);
+    }
+
+    // Writes a contiguous array of trivially copyable objects at once
+    template <typename T, std::size_t Extent>
+        requires TriviallySerializable<T>
+    FileOpResult<> write_range(this File &self, std::span<T, Extent> range)
+    {
+        return self.write(std::as_bytes(range));
+    }
+
     template <Serializable T>
     FileOpResult<> read(this File &self, T &obj)
     {
-        if (self.m_mode == FileMode::read)
+        if (self.m_mode != FileMode::read)
         {
-            return std::unexpected{ ModeInconsistent{ self.m_path, self.m_mode, FileMode::read } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::read } };
         }
 
-        if constexpr (Serializable<T>)
+        if constexpr (ManSerializable<T>)
         {
+            std::size_t size = sizeof(T);
+            if constexpr (IntoSerializable<T>)
+            {
+                size = obj.serialized_size();
+            }
+
             if (self.m_use_buffer)
             {
-                if (self.m_buf.end() - self.m_buf_it < sizeof(T))
+                if (static_cast<std::size_t>(self.m_buf.end() - self.m_buf_it) < size)
                 {
-                    return std::unexpected{ FileReadFailed{ self.m_path } };
+                    return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
                 }
-                obj.deserialize(std::span(self.m_buf_it, sizeof(T)));
-                self.m_buf_it += sizeof(T);
+                auto bytes = std::span(self.m_buf_it, size);
+                self.track(bytes);
+                obj.deserialize(bytes);
+                self.m_buf_it += size;
             }
             else
             {
-                std::vector<std::byte> buf(sizeof(obj), std::byte{});
-                auto read_count = std::fread(buf.data(), sizeof(obj), 1, self.m_handle.get());
-                if (read_count != 1)
+                auto &scratch = detail::serialize_scratch();
+                scratch.resize(size);
+                if (!native::read_all(self.m_handle, scratch))
                 {
-                    return std::unexpected{ FileReadFailed{ self.m_path } };
+                    return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
                 }
-                obj.deserialize(std::span(buf.begin(), buf.end()));
+                self.track(scratch);
+                obj.deserialize(std::span{ scratch });
             }
+
+            return {};
         }
         else
         {
-            if (self.m_use_buffer)
-            {
-                if (self.m_buf.end() - self.m_buf_it < sizeof(T))
-                {
-                    return std::unexpected{ FileReadFailed{ self.m_path } };
-                }
-                std::memcpy(&obj, &*self.m_buf_it, sizeof(T));
-                self.m_buf_it += sizeof(T);
-            }
-            else
-            {
-                auto read_count = std::fread(&obj, sizeof(obj), 1, self.m_handle.get());
-                if (read_count != 1)
-                {
-                    return std::unexpected{ FileReadFailed{ self.m_path } };
-                }
-            }
+            return self.read(std::as_writable_bytes(std::span{ &obj, 1 }));
         }
+    }
 
-        return {};
+    // Reads a contiguous array of trivially copyable objects at once
+    template <typename T, std::size_t Extent>
+        requires(TriviallySerializable<T> && !std::is_const_v<T>)
+    FileOpResult<> read_range(this File &self, std::span<T, Extent> range)
+    {
+        return self.read(std::as_writable_bytes(range));
     }
 
     FileOpResult<> read(this File &self, std::span<std::byte> buf)
     {
         if (self.m_mode == FileMode::write)
         {
-            return std::unexpected{ ModeInconsistent{ self.m_path, self.m_mode, FileMode::read } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::read } };
         }
 
         if (self.m_use_buffer)
         {
             if (static_cast<std::size_t>(self.m_buf.end() - self.m_buf_it) < buf.size())
             {
-                return std::unexpected{ FileReadFailed{ self.m_path } };
+                return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
             }
             std::memcpy(buf.data(), &*self.m_buf_it, buf.size());
             self.m_buf_it += buf.size();
         }
         else
         {
-            auto read_size = std::fread(buf.data(), buf.size(), 1, self.m_handle.get());
-            if (read_size != 1)
+            if (!native::read_all(self.m_handle, buf))
             {
-                return std::unexpected{ FileReadFailed{ self.m_path } };
+                return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
             }
         }
 
+        self.track(buf);
         return {};
     }
 
+    // Zero runs at least this long are skipped over instead of written, leaving a hole in the file
+    static constexpr std::size_t sparse_padding_threshold = 4096;
+
     FileOpResult<> padding(this File &self, std::size_t count, std::byte byte = std::byte{ 0 })
     {
-        static std::vector<std::byte> temp_buf{};
-
         if (self.m_mode == FileMode::read)
         {
-            return std::unexpected{ ModeInconsistent{ self.m_path, self.m_mode, FileMode::write } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
         }
 
-        if (self.m_use_buffer)
+        if (byte == std::byte{ 0 } && count >= sparse_padding_threshold)
         {
-            self.m_buf.resize(self.m_buf.size() + count, byte);
-            return {};
+            if (auto flush_result = self.flush(); !flush_result)
+            {
+                return flush_result;
+            }
+            if (native::skip_zeros(self.m_handle, count))
+            {
+                // The skipped zeros still count towards the stream checksum
+                if (self.m_checksum)
+                {
+                    auto zeros = detail::padding_pattern(std::byte{ 0 });
+                    for (std::size_t left = count; left != 0;)
+                    {
+                        std::size_t chunk = std::min(left, zeros.size());
+                        self.m_checksum->update(zeros.first(chunk));
+                        left -= chunk;
+                    }
+                }
+                return {};
+            }
         }
 
-        if (temp_buf.size() < count)
+        auto pattern = detail::padding_pattern(byte);
+        while (count != 0)
         {
-            temp_buf.resize(count, byte);
+            std::size_t chunk = std::min(count, pattern.size());
+            if (auto write_result = self.write_bytes(std::span{ pattern.data(), chunk }); !write_result)
+            {
+                return write_result;
+            }
+            count -= chunk;
         }
-        else
+
+        return {};
+    }
+
+    // Preallocates storage for the first `bytes` bytes of the file without changing its size
+    FileOpResult<> reserve(this File &self, std::uint64_t bytes)
+    {
+        if (self.m_mode != FileMode::write)
         {
-            std::memset(temp_buf.data(), static_cast<int>(byte), count);
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
         }
 
-        auto written_count = std::fwrite(temp_buf.data(), count * sizeof(std::byte), 1, self.m_handle.get());
-        if (written_count != 1)
+        if (!native::reserve(self.m_handle, bytes))
         {
-            return std::unexpected{ FileReadFailed{ self.m_path } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::write_failed, self.m_path } };
         }
 
         return {};
@@ -370,21 +590,22 @@ public:
 
     FileOpResult<> flush(this File &self)
     {
+        FT_TRACE_SCOPE("File::flush");
         if (self.m_mode == FileMode::read)
         {
-            return std::unexpected{ ModeInconsistent{ self.m_path, self.m_mode, FileMode::write } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
         }
 
-        if (!self.m_use_buffer)
+        if (!self.m_use_buffer || self.m_buf.empty())
         {
             return {};
         }
 
-        auto written_count = std::fwrite(self.m_buf.data(), self.m_buf.size(), 1, self.m_handle.get());
-        if (written_count != 1)
+        if (!native::write_all(self.m_handle, self.m_buf))
         {
-            return std::unexpected{ FileWriteFailed{ self.m_path } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::write_failed, self.m_path } };
         }
+        metrics::add(metrics::Counter::file_flushes);
 
         self.m_buf.clear();
         self.m_buf_it = self.m_buf.begin();
@@ -392,11 +613,175 @@ public:
         return {};
     }
 
+    // Flushes pending writes and releases the file, the file is no longer valid afterwards
+    FileOpResult<> close(this File &self)
+    {
+        FileOpResult<> ret;
+        if (self.m_mode == FileMode::write && self.m_handle != native::invalid_handle)
+        {
+            ret = self.flush();
+        }
+
+        self.close_file();
+        self.m_buf.clear();
+        self.m_valid = false;
+        return ret;
+    }
+
+    // Positional writes bypass the buffer and leave the sequential position alone, so threads can fill
+    // disjoint regions of one file concurrently
+    FileOpResult<> write_at(this const File &self, std::uint64_t offset, std::span<const std::byte> bytes)
+    {
+        if (self.m_mode != FileMode::write)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
+        }
+
+        if (!native::write_at(self.m_handle, offset, bytes))
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::write_failed, self.m_path } };
+        }
+
+        return {};
+    }
+
+    FileOpResult<> read_at(this const File &self, std::uint64_t offset, std::span<std::byte> bytes)
+    {
+        if (self.m_mode != FileMode::read)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::read } };
+        }
+
+        if (self.m_use_buffer)
+        {
+            if (offset > self.m_buf.size() || self.m_buf.size() - offset < bytes.size())
+            {
+                return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
+            }
+            std::memcpy(bytes.data(), self.m_buf.data() + offset, bytes.size());
+        }
+        else if (!native::read_at(self.m_handle, offset, bytes))
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
+        }
+
+        return {};
+    }
+
+    void advise(this const File &self, AccessHint hint)
+    {
+        if (self.m_handle != native::invalid_handle)
+        {
+            native::advise(self.m_handle, hint);
+        }
+    }
+
+    // Size of the file's content, including writes still in the buffer
+    std::uint64_t size(this const File &self)
+    {
+        std::uint64_t on_disk = 0;
+        if (self.m_handle != native::invalid_handle)
+        {
+            on_disk = native::size(self.m_handle).value_or(0);
+        }
+
+        if (self.m_mode == FileMode::read && self.m_use_buffer)
+        {
+            return self.m_buf.size();
+        }
+        return self.m_mode == FileMode::write ? on_disk + self.m_buf.size() : on_disk;
+    }
+
+    // Starts a CRC-32C over every byte written or read sequentially from now on, positional I/O is not covered
+    void enable_checksum(this File &self) { self.m_checksum.emplace(); }
+
+    std::optional<std::uint32_t> checksum(this const File &self)
+    {
+        if (!self.m_checksum)
+        {
+            return std::nullopt;
+        }
+        return self.m_checksum->value();
+    }
+
+    // Appends the checksum of everything written so far, enable_checksum() must have been called before the
+    // first write
+    FileOpResult<> write_checksum_trailer(this File &self)
+    {
+        if (self.m_mode != FileMode::write)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
+        }
+
+        if (!self.m_checksum)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::write_failed, self.m_path } };
+        }
+
+        ChecksumTrailer trailer;
+        trailer.magic = checksum_trailer_magic;
+        trailer.checksum = self.m_checksum->value();
+        return self.write(trailer);
+    }
+
+    // Checks the whole file against the trailer written by write_checksum_trailer()
+    FileOpResult<> verify_checksum_trailer(this const File &self)
+    {
+        if (self.m_mode != FileMode::read)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::read } };
+        }
+
+        constexpr std::size_t trailer_size = schema_size<ChecksumTrailer>();
+        std::uint64_t file_size = self.size();
+        if (file_size < trailer_size)
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::checksum_mismatch, self.m_path } };
+        }
+
+        std::uint64_t payload_size = file_size - trailer_size;
+        std::array<std::byte, trailer_size> trailer_bytes;
+        Crc32c crc;
+        if (self.m_use_buffer)
+        {
+            crc.update(std::span{ self.m_buf }.first(payload_size));
+            std::memcpy(trailer_bytes.data(), self.m_buf.data() + payload_size, trailer_size);
+        }
+        else
+        {
+            auto &scratch = detail::serialize_scratch();
+            scratch.resize(default_high_water);
+            for (std::uint64_t offset = 0; offset < payload_size;)
+            {
+                auto chunk = static_cast<std::size_t>(std::min<std::uint64_t>(scratch.size(), payload_size - offset));
+                if (!native::read_at(self.m_handle, offset, std::span{ scratch }.first(chunk)))
+                {
+                    return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
+                }
+                crc.update(std::span{ scratch }.first(chunk));
+                offset += chunk;
+            }
+            if (!native::read_at(self.m_handle, payload_size, trailer_bytes))
+            {
+                return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, self.m_path } };
+            }
+        }
+
+        ChecksumTrailer trailer;
+        schema_decode(trailer, trailer_bytes);
+        if (trailer.magic != checksum_trailer_magic || trailer.checksum != crc.value())
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::checksum_mismatch, self.m_path } };
+        }
+
+        return {};
+    }
+
     FileOpResult<> flush_to(this File &self, std::ostream &os)
     {
         if (self.m_mode == FileMode::read)
         {
-            return std::unexpected{ ModeInconsistent{ self.m_path, self.m_mode, FileMode::write } };
+            return std::unexpected{ FileOpErr{ FileOpErrCode::mode_inconsistent, self.m_path, self.m_mode, FileMode::write } };
         }
 
         if (self.m_use_buffer)
@@ -407,33 +792,46 @@ public:
     }
 
 private:
+    struct ChecksumTrailer : SchemaRecord<ChecksumTrailer>
+    {
+        std::uint32_t magic = 0;
+        std::uint32_t checksum = 0;
+
+        static constexpr auto schema = std::tuple{ &ChecksumTrailer::magic, &ChecksumTrailer::checksum };
+    };
+
+    // "FTCK" once encoded little-endian
+    static constexpr std::uint32_t checksum_trailer_magic = 0x4b435446;
+
     File(const std::filesystem::path &file_path, FileMode mode, bool use_buffer)
+        : File(native::open(file_path, mode == FileMode::write), file_path, mode, use_buffer)
+    {
+    }
+
+    File(native::Handle handle, const std::filesystem::path &file_path, FileMode mode, bool use_buffer)
         : m_path(file_path)
         , m_use_buffer(use_buffer)
         , m_mode(mode)
+        , m_handle(handle)
     {
-        std::error_code ec;
-        auto size = std::filesystem::file_size(file_path, ec);
-        if (mode == FileMode::read && ec)
+        if (m_handle == native::invalid_handle)
         {
             return;
         }
 
-        std::FILE *fptr;
-        fopen_s(&fptr, reinterpret_cast<const char *>(file_path.u8string().c_str()), mode_flag(mode));
-        if (!fptr)
+        if (mode == FileMode::read && use_buffer)
         {
-            return;
-        }
-        m_handle.reset(fptr);
+            auto size = native::size(m_handle);
+            if (!size)
+            {
+                return;
+            }
 
-        if (mode == FileMode::read && use_buffer && m_handle)
-        {
-            m_buf.resize(size);
+            m_buf.resize(*size);
             m_buf_it = m_buf.begin();
-            auto read_count = std::fread(m_buf.data(), size, 1, m_handle.get());
+            bool read_result = native::read_all(m_handle, m_buf);
             close_file();
-            if (read_count != 1)
+            if (!read_result)
             {
                 return;
             }
@@ -442,33 +840,76 @@ private:
         m_valid = true;
     }
 
-    void close_file(this File &self) { self.m_handle.reset(); }
+    void close_file(this File &self)
+    {
+        if (self.m_handle != native::invalid_handle)
+        {
+            native::close(std::exchange(self.m_handle, native::invalid_handle));
+        }
+    }
 
-    static void release_file_handle(std::FILE *f) { std::fclose(f); }
+    void close_deferred(this File &self)
+    {
+        if (auto close_result = self.close(); !close_result)
+        {
+            detail::deferred_errors().push_back(std::move(close_result.error()));
+        }
+    }
 
-    static constexpr const char *mode_flag(FileMode mode)
+    void track(this File &self, std::span<const std::byte> bytes)
     {
-        switch (mode)
+        if (self.m_checksum)
         {
-        case FileMode::read:
-            return "rb+";
-            break;
-        case FileMode::write:
-            return "wb+";
-            break;
-        default:
-            return "";
-            break;
+            self.m_checksum->update(bytes);
         }
     }
 
+    FileOpResult<> write_bytes(this File &self, std::span<const std::byte> bytes)
+    {
+        self.track(bytes);
+
+        if (self.m_use_buffer)
+        {
+            if (self.m_buf.size() + bytes.size() <= self.m_high_water)
+            {
+                self.m_buf.insert(self.m_buf.end(), bytes.begin(), bytes.end());
+                return {};
+            }
+
+            if (auto flush_result = self.flush(); !flush_result)
+            {
+                return flush_result;
+            }
+
+            if (bytes.size() < self.m_high_water)
+            {
+                self.m_buf.insert(self.m_buf.end(), bytes.begin(), bytes.end());
+                return {};
+            }
+        }
+
+        if (bytes.empty())
+        {
+            return {};
+        }
+
+        if (!native::write_all(self.m_handle, bytes))
+        {
+            return std::unexpected{ FileOpErr{ FileOpErrCode::write_failed, self.m_path } };
+        }
+
+        return {};
+    }
+
 private:
     std::vector<std::byte> m_buf;
     std::filesystem::path m_path;
-    std::unique_ptr<std::FILE, void (*)(std::FILE *)> m_handle{ nullptr, File::release_file_handle };
     std::vector<std::byte>::iterator m_buf_it;
+    std::size_t m_high_water = default_high_water;
     bool m_use_buffer;
     bool m_valid = false;
     FileMode m_mode;
+    std::optional<Crc32c> m_checksum;
+    native::Handle m_handle = native::invalid_handle;
 };
 } // namespace ft
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "file_lock.h"
+
+#ifdef FT_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elifdef FT_PLATFORM_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#else
+#error "System not supported."
+#endif
+
+namespace ft
+{
+FileOpResult<FileLock> FileLock::acquire(const std::filesystem::path &lock_path, LockMode mode)
+{
+#ifdef FT_PLATFORM_WINDOWS
+    HANDLE handle = ::CreateFileW(lock_path.c_str(),
+                                  GENERIC_READ | GENERIC_WRITE,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  nullptr,
+                                  OPEN_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL,
+                                  nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::lock_failed, lock_path } };
+    }
+
+    OVERLAPPED overlapped{};
+    DWORD flags = mode == LockMode::exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0;
+    if (!::LockFileEx(handle, flags, 0, MAXDWORD, MAXDWORD, &overlapped))
+    {
+        ::CloseHandle(handle);
+        return std::unexpected{ FileOpErr{ FileOpErrCode::lock_failed, lock_path } };
+    }
+
+    return FileLock{ reinterpret_cast<std::intptr_t>(handle) };
+#else
+    int fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::lock_failed, lock_path } };
+    }
+
+    int operation = mode == LockMode::exclusive ? LOCK_EX : LOCK_SH;
+    while (::flock(fd, operation) != 0)
+    {
+        if (errno != EINTR)
+        {
+            ::close(fd);
+            return std::unexpected{ FileOpErr{ FileOpErrCode::lock_failed, lock_path } };
+        }
+    }
+
+    return FileLock{ fd };
+#endif
+}
+
+void FileLock::release()
+{
+    if (m_handle == invalid_handle)
+    {
+        return;
+    }
+
+#ifdef FT_PLATFORM_WINDOWS
+    ::CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+#else
+    ::close(static_cast<int>(m_handle));
+#endif
+    m_handle = invalid_handle;
+}
+} // namespace ft
\ No newline at end of file
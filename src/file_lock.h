@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+
+#include "file_io.hpp"
+
+namespace ft
+{
+enum class LockMode
+{
+    shared,
+    exclusive
+};
+
+// Advisory lock shared between processes, held on a dedicated lock file until destruction
+class FileLock
+{
+public:
+    static FileOpResult<FileLock> acquire(const std::filesystem::path &lock_path, LockMode mode);
+
+public:
+    FileLock(FileLock &&another) noexcept
+        : m_handle(std::exchange(another.m_handle, invalid_handle))
+    {
+    }
+    FileLock(const FileLock &) = delete;
+
+    FileLock &operator=(const FileLock &) = delete;
+    FileLock &operator=(FileLock &&) = delete;
+
+    ~FileLock() { release(); }
+
+private:
+    FileLock(std::intptr_t handle)
+        : m_handle(handle)
+    {
+    }
+
+    void release();
+
+private:
+    static constexpr std::intptr_t invalid_handle = -1;
+
+    std::intptr_t m_handle;
+};
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "file_watcher.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+namespace ft
+{
+#ifdef __linux__
+// Other files of the same directory, e.g. the cache's lock and temporary files, are filtered out by name
+constexpr std::uint32_t watched_events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+#else
+constexpr std::chrono::milliseconds poll_interval{ 250 };
+#endif
+
+FileOpResult<FileWatcher> FileWatcher::create(const std::filesystem::path &path)
+{
+    auto absolute = std::filesystem::absolute(path);
+    std::error_code ec;
+    std::filesystem::create_directories(absolute.parent_path(), ec);
+
+#ifdef __linux__
+    int fd = ::inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::open_failed, path } };
+    }
+    if (::inotify_add_watch(fd, absolute.parent_path().c_str(), watched_events) < 0)
+    {
+        ::close(fd);
+        return std::unexpected{ FileOpErr{ FileOpErrCode::open_failed, path } };
+    }
+
+    return FileWatcher{ std::move(absolute), fd };
+#else
+    FileWatcher watcher{ std::move(absolute), invalid_handle };
+    watcher.m_lastWrite = std::filesystem::last_write_time(watcher.m_path, ec);
+    watcher.m_lastSize = ec ? 0 : std::filesystem::file_size(watcher.m_path, ec);
+    return watcher;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (m_handle != invalid_handle)
+    {
+        ::close(static_cast<int>(m_handle));
+    }
+#endif
+}
+
+bool FileWatcher::wait(this FileWatcher &self, std::chrono::milliseconds quiet)
+{
+    for (;;)
+    {
+        auto changed = self.changed(std::chrono::milliseconds{ -1 });
+        if (!changed)
+        {
+            return false;
+        }
+        if (*changed)
+        {
+            break;
+        }
+    }
+
+    for (;;)
+    {
+        auto changed = self.changed(quiet);
+        if (!changed)
+        {
+            return false;
+        }
+        if (!*changed)
+        {
+            return true;
+        }
+    }
+}
+
+std::optional<bool> FileWatcher::changed(this FileWatcher &self, std::chrono::milliseconds timeout)
+{
+    using clock = std::chrono::steady_clock;
+    bool forever = timeout.count() < 0;
+    auto deadline = clock::now() + std::max(timeout, std::chrono::milliseconds{ 0 });
+
+#ifdef __linux__
+    auto name = self.m_path.filename().native();
+    for (;;)
+    {
+        int wait_ms = -1;
+        if (!forever)
+        {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now());
+            wait_ms = static_cast<int>(std::max(left.count(), std::chrono::milliseconds::rep{ 0 }));
+        }
+
+        pollfd pfd{ static_cast<int>(self.m_handle), POLLIN, 0 };
+        int ready = ::poll(&pfd, 1, wait_ms);
+        if (ready < 0 && errno != EINTR)
+        {
+            return std::nullopt;
+        }
+        if (ready == 0)
+        {
+            return false;
+        }
+        if (ready < 0)
+        {
+            continue;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length = ::read(static_cast<int>(self.m_handle), buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (length <= 0)
+        {
+            return std::nullopt;
+        }
+
+        bool relevant = false;
+        for (char *pos = buffer; pos < buffer + length;)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(pos);
+            // The directory itself was removed, nothing will be reported anymore
+            if (event->mask & IN_IGNORED)
+            {
+                return std::nullopt;
+            }
+            if (event->len != 0 && name == event->name)
+            {
+                relevant = true;
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+
+        if (relevant)
+        {
+            return true;
+        }
+    }
+#else
+    for (;;)
+    {
+        std::error_code ec;
+        auto last_write = std::filesystem::last_write_time(self.m_path, ec);
+        std::uintmax_t size = ec ? 0 : std::filesystem::file_size(self.m_path, ec);
+        if (ec)
+        {
+            last_write = {};
+            size = 0;
+        }
+
+        if (last_write != self.m_lastWrite || size != self.m_lastSize)
+        {
+            self.m_lastWrite = last_write;
+            self.m_lastSize = size;
+            return true;
+        }
+
+        auto now = clock::now();
+        if (!forever && now >= deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(forever ? poll_interval
+                                            : std::min<clock::duration>(poll_interval, deadline - now));
+    }
+#endif
+}
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <utility>
+
+#include "file_io.hpp"
+
+namespace ft
+{
+// Reports changes to a single file, including its replacement by a rename as done for the config cache. The parent
+// directory is watched, so the file does not have to exist yet
+class FileWatcher
+{
+public:
+    static FileOpResult<FileWatcher> create(const std::filesystem::path &path);
+
+public:
+    FileWatcher(FileWatcher &&another) noexcept
+        : m_path(std::move(another.m_path))
+        , m_handle(std::exchange(another.m_handle, invalid_handle))
+        , m_lastWrite(another.m_lastWrite)
+        , m_lastSize(another.m_lastSize)
+    {
+    }
+    FileWatcher(const FileWatcher &) = delete;
+
+    FileWatcher &operator=(const FileWatcher &) = delete;
+    FileWatcher &operator=(FileWatcher &&) = delete;
+
+    ~FileWatcher();
+
+    // Blocks until the file changes, then until it stays unchanged for `quiet`, so that a burst of writes is
+    // reported once. False if the file can no longer be watched
+    bool wait(this FileWatcher &self, std::chrono::milliseconds quiet);
+
+private:
+    FileWatcher(std::filesystem::path path, std::intptr_t handle)
+        : m_path(std::move(path))
+        , m_handle(handle)
+    {
+    }
+
+    // Waits at most `timeout` for a change, a negative timeout waits forever
+    std::optional<bool> changed(this FileWatcher &self, std::chrono::milliseconds timeout);
+
+private:
+    static constexpr std::intptr_t invalid_handle = -1;
+
+    std::filesystem::path m_path;
+    // inotify instance where available, the polling fallback compares modification time and size instead
+    std::intptr_t m_handle;
+    std::filesystem::file_time_type m_lastWrite{};
+    std::uintmax_t m_lastSize = 0;
+};
+} // namespace ft
\ No newline at end of file
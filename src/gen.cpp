@@ -1,7 +1,6 @@
 #include <memory>
 
 #include "gen.h"
-#include "argparse/argparse.hpp"
 #include "cmake_gen.h"
 
 namespace ft
@@ -24,12 +23,12 @@ bool Output::output()
     return m_base->do_output();
 }
 
-ScopeCacher ScopeCacher::create(FileType type, argparse::ArgumentParser &parser)
+ScopeCacher ScopeCacher::create(FileType type)
 {
     switch (type)
     {
     case FileType::CMake:
-        return ScopeCacher{ std::make_unique<detail::CacherAdapter<CMakeCacher>>(parser) };
+        return ScopeCacher{ std::make_unique<detail::CacherAdapter<CMakeCacher>>() };
         break;
     default:
         throw;
@@ -3,7 +3,6 @@
 #include <memory>
 #include <type_traits>
 
-#include "argparse/argparse.hpp"
 #include "file_types.h"
 
 namespace ft
@@ -67,7 +66,7 @@ namespace detail
 
     template <typename T>
     concept ImplCacher = requires(T t) {
-        requires std::is_constructible_v<T, argparse::ArgumentParser &>;
+        requires std::is_nothrow_default_constructible_v<T>;
         t.update();
     };
 
@@ -75,10 +74,7 @@ namespace detail
     class CacherAdapter final : public CacherBase
     {
     public:
-        CacherAdapter(argparse::ArgumentParser &parser) noexcept
-            : obj(parser)
-        {
-        }
+        CacherAdapter() noexcept {}
 
         CacherAdapter(const CacherAdapter &) = delete;
         CacherAdapter &operator=(const CacherAdapter &) = delete;
@@ -117,7 +113,7 @@ class ScopeCacher
 public:
     // Ctor optionally loads caches from file to ArgumentStorage
     [[nodiscard("ScopeCacher's correctness relies on its lifetime")]]
-    static ScopeCacher create(FileType type, argparse::ArgumentParser &parser);
+    static ScopeCacher create(FileType type);
 
     ScopeCacher(ScopeCacher &&) = default;
     ScopeCacher &operator=(ScopeCacher &&) = default;
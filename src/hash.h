@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace ft
+{
+// 64-bit FNV-1a, usable in constant evaluation so that option names can be hashed at compile time
+constexpr std::uint64_t fnv1a(std::string_view str) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (auto &&c : str)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+} // namespace ft
\ No newline at end of file
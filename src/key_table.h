@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "hash.h"
+
+namespace ft
+{
+// Open-addressing table keyed by a precomputed 64-bit hash, the key string is kept only to resolve collisions
+template <typename T>
+class KeyTable
+{
+public:
+    KeyTable(std::size_t expected = 8)
+        : m_slots(capacity_for(expected))
+    {
+    }
+
+    T *find(this KeyTable &self, std::uint64_t hash, std::string_view key)
+    {
+        std::size_t mask = self.m_slots.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            auto &slot = self.m_slots[i];
+            if (!slot.used)
+            {
+                return nullptr;
+            }
+            if (slot.hash == hash && slot.key == key)
+            {
+                return &slot.value;
+            }
+        }
+    }
+
+    T *find(this KeyTable &self, std::string_view key) { return self.find(fnv1a(key), key); }
+
+    T &insert_or_assign(this KeyTable &self, std::uint64_t hash, std::string_view key, T value)
+    {
+        if (T *found = self.find(hash, key))
+        {
+            *found = std::move(value);
+            return *found;
+        }
+
+        if ((self.m_count + 1) * 2 > self.m_slots.size())
+        {
+            self.rehash(self.m_slots.size() * 2);
+        }
+
+        auto &slot = self.probe_free(hash);
+        slot.used = true;
+        slot.hash = hash;
+        slot.key = key;
+        slot.value = std::move(value);
+        ++self.m_count;
+        return slot.value;
+    }
+
+    T &insert_or_assign(this KeyTable &self, std::string_view key, T value)
+    {
+        return self.insert_or_assign(fnv1a(key), key, std::move(value));
+    }
+
+    std::size_t size(this const KeyTable &self) { return self.m_count; }
+
+private:
+    struct Slot
+    {
+        std::uint64_t hash = 0;
+        std::string key;
+        T value{};
+        bool used = false;
+    };
+
+    static std::size_t capacity_for(std::size_t expected)
+    {
+        std::size_t capacity = 8;
+        while (capacity < expected * 2)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    Slot &probe_free(this KeyTable &self, std::uint64_t hash)
+    {
+        std::size_t mask = self.m_slots.size() - 1;
+        std::size_t i = hash & mask;
+        while (self.m_slots[i].used)
+        {
+            i = (i + 1) & mask;
+        }
+        return self.m_slots[i];
+    }
+
+    void rehash(this KeyTable &self, std::size_t capacity)
+    {
+        std::vector<Slot> old = std::exchange(self.m_slots, std::vector<Slot>(capacity));
+        for (auto &&slot : old)
+        {
+            if (slot.used)
+            {
+                self.probe_free(slot.hash) = std::move(slot);
+            }
+        }
+    }
+
+private:
+    std::vector<Slot> m_slots;
+    std::size_t m_count = 0;
+};
+} // namespace ft
\ No newline at end of file
@@ -1,50 +1,58 @@
 #include <argparse/argparse.hpp>
 #include <exception>
+#include <optional>
 
 #include "arg/arg_basic.h"
 #include "arg/arg_def.h"
+#include "arg/arg_parser.h"
 #include "arg/args.h"
+#include "cmake_gen.h"
+#include "file_io.hpp"
 #include "gen.h"
+#include "log.hpp"
+#include "metrics.h"
+#include "trace.h"
 
 using namespace argparse;
 using namespace ft;
 
-#define ARG(def) def.full_name(), def.short_name()
+#define ARG(def) def.full_name(), def.full_short_name()
 
-int main(int argc, char **argv)
+// Slow path of fast_parse(), also the one reporting errors and printing help
+static std::optional<Subcommand> parse_with_argparse(int argc, char **argv)
 {
     ArgumentParser program{ "filetemp", "0.1.0" };
 
     ArgumentParser cmake_parser{ "cmake", "", default_arguments::help };
     cmake_parser.add_argument(Args::CMAKE_WORKDIRECTORY.full_name())
         .help("The output directory")
-        .default_value<std::string>(".")
+        .default_value(*Args::CMAKE_WORKDIRECTORY)
         .store_into(&Args::CMAKE_WORKDIRECTORY);
     cmake_parser.add_argument(ARG(Args::CMAKE_VERSION))
         .help("Minimum cmake version")
-        .default_value<std::string>("3.0")
+        .default_value(*Args::CMAKE_VERSION)
         .metavar("<ver>")
         .store_into(&Args::CMAKE_VERSION);
     cmake_parser.add_argument(ARG(Args::CMAKE_CSTD))
         .help("C standard")
         .scan<'i', ArgType(Args::CMAKE_CSTD)>()
-        .default_value(99)
+        .default_value(*Args::CMAKE_CSTD)
         .metavar("<std>")
         .store_into(&Args::CMAKE_CSTD);
     cmake_parser.add_argument(ARG(Args::CMAKE_CXXSTD))
         .help("C++ standard")
         .scan<'i', ArgType(Args::CMAKE_CXXSTD)>()
-        .default_value(20)
+        .default_value(*Args::CMAKE_CXXSTD)
         .metavar("<std>")
         .store_into(&Args::CMAKE_CXXSTD);
     cmake_parser.add_argument(ARG(Args::CMAKE_PROJECT))
         .help("Project and executable name")
-        .default_value<std::string>("foo")
+        .default_value(*Args::CMAKE_PROJECT)
         .metavar("<name>")
         .store_into(&Args::CMAKE_PROJECT);
     cmake_parser.add_argument(ARG(Args::CMAKE_MAINLANG))
         .help("Main language of the project")
-        .default_value<std::string>("CXX")
+        .default_value(*Args::CMAKE_MAINLANG)
         .metavar("<lang>")
         .store_into(&Args::CMAKE_MAINLANG);
     cmake_parser.add_argument(ARG(Args::CMAKE_SAVEAS))
@@ -67,8 +75,63 @@ int main(int argc, char **argv)
         .help("Show output to console")
         .flag()
         .store_into(&Args::CMAKE_SHOW);
+    cmake_parser.add_argument(ARG(Args::CMAKE_HEADERMODE))
+        .help("How standard headers are consumed: include, pch or module (import std, pch as fallback)")
+        .default_value(*Args::CMAKE_HEADERMODE)
+        .choices("include", "pch", "module")
+        .metavar("<mode>")
+        .store_into(&Args::CMAKE_HEADERMODE);
+    cmake_parser.add_argument(ARG(Args::CMAKE_BUILDPROFILE))
+        .help("Build performance profile: none, dev (ccache, fast linker, split DWARF) or release (also unity build "
+              "and IPO)")
+        .default_value(*Args::CMAKE_BUILDPROFILE)
+        .choices("none", "dev", "release")
+        .metavar("<profile>")
+        .store_into(&Args::CMAKE_BUILDPROFILE);
+    cmake_parser.add_argument(ARG(Args::CMAKE_PRESETS))
+        .help("Generate CMakePresets.json with release, PGO, sanitizer and benchmark presets (CMake 3.25)")
+        .flag()
+        .store_into(&Args::CMAKE_PRESETS);
+    cmake_parser.add_argument(ARG(Args::CMAKE_WITHBENCH))
+        .help("Generate a Google Benchmark target in bench/")
+        .flag()
+        .store_into(&Args::CMAKE_WITHBENCH);
+    cmake_parser.add_argument(ARG(Args::CMAKE_WITHPROFILING))
+        .help("Generate an ENABLE_PROFILING option and profiling zone macros in src/profile.h")
+        .flag()
+        .store_into(&Args::CMAKE_WITHPROFILING);
+    cmake_parser.add_argument(ARG(Args::CMAKE_UPDATE))
+        .help("Raise the minimum version and standards of an existing CMakeLists.txt in place")
+        .flag()
+        .store_into(&Args::CMAKE_UPDATE);
+    cmake_parser.add_argument(ARG(Args::CMAKE_METRICS))
+        .help("Write run metrics on exit, as a Prometheus textfile if the name ends in .prom and JSON otherwise")
+        .metavar("<file>")
+        .store_into(&Args::CMAKE_METRICS);
+    cmake_parser.add_argument(ARG(Args::CMAKE_TRACE))
+        .help("Write a Chrome trace of the run on exit, viewable in Perfetto")
+        .metavar("<file>")
+        .store_into(&Args::CMAKE_TRACE);
+    cmake_parser.add_argument(ARG(Args::CMAKE_MANIFEST))
+        .help("Generate every project listed in a CSV manifest of directory[,project[,config]] lines, directories "
+              "are relative to <directory>")
+        .metavar("<file>")
+        .store_into(&Args::CMAKE_MANIFEST);
+    cmake_parser.add_argument(ARG(Args::CMAKE_WATCHABLE))
+        .help("Record the generated directories for `watch`, only with --use-config or a manifest config")
+        .flag()
+        .store_into(&Args::CMAKE_WATCHABLE);
+
+    ArgumentParser watch_parser{ "watch", "", default_arguments::help };
+    watch_parser.add_argument(ARG(Args::WATCH_DEBOUNCE))
+        .help("Milliseconds without further changes before regenerating")
+        .scan<'i', ArgType(Args::WATCH_DEBOUNCE)>()
+        .default_value(*Args::WATCH_DEBOUNCE)
+        .metavar("<ms>")
+        .store_into(&Args::WATCH_DEBOUNCE);
 
     program.add_subparser(cmake_parser);
+    program.add_subparser(watch_parser);
 
     try
     {
@@ -77,7 +140,7 @@ int main(int argc, char **argv)
     catch (const std::exception &e)
     {
         std::cout << e.what() << std::endl;
-        return -1;
+        return std::nullopt;
     }
 
     if (argc < 2)
@@ -85,16 +148,105 @@ int main(int argc, char **argv)
         std::cout << program;
     }
 
+    auto mark_given = [](ArgumentParser &parser, auto &...args)
+    {
+        ((parser.is_used(args.full_name()) ? args.mark_given() : void()), ...);
+    };
+
+    if (program.is_subcommand_used("cmake"))
+    {
+        mark_given(cmake_parser,
+                   Args::CMAKE_WORKDIRECTORY,
+                   Args::CMAKE_VERSION,
+                   Args::CMAKE_CSTD,
+                   Args::CMAKE_CXXSTD,
+                   Args::CMAKE_PROJECT,
+                   Args::CMAKE_MAINLANG,
+                   Args::CMAKE_SAVEAS,
+                   Args::CMAKE_USECONFIG,
+                   Args::CMAKE_EXPORTCMD,
+                   Args::CMAKE_GENSRC,
+                   Args::CMAKE_SHOW,
+                   Args::CMAKE_HEADERMODE,
+                   Args::CMAKE_BUILDPROFILE,
+                   Args::CMAKE_PRESETS,
+                   Args::CMAKE_WITHBENCH,
+                   Args::CMAKE_WITHPROFILING,
+                   Args::CMAKE_UPDATE,
+                   Args::CMAKE_METRICS,
+                   Args::CMAKE_TRACE,
+                   Args::CMAKE_MANIFEST,
+                   Args::CMAKE_WATCHABLE);
+        return Subcommand::cmake;
+    }
+    if (program.is_subcommand_used("watch"))
+    {
+        mark_given(watch_parser, Args::WATCH_DEBOUNCE);
+        return Subcommand::watch;
+    }
+    return Subcommand::none;
+}
+
+// Errors of files that were only closed by their destructor, on the main thread
+static bool report_deferred_errors()
+{
+    auto errors = File::take_deferred_errors();
+    for (auto &&error : errors)
+    {
+        log_err("{}", error.msg());
+    }
+    return errors.empty();
+}
+
+int main(int argc, char **argv)
+{
+    // Tracing is only enabled by the options parsed below, the parsing is recorded afterwards
+    auto parse_start = trace::clock::now();
+
+    auto command = fast_parse(argc, argv);
+    if (!command)
+    {
+        command = parse_with_argparse(argc, argv);
+        if (!command)
+        {
+            return -1;
+        }
+    }
+
+    if (!(*Args::CMAKE_TRACE).empty())
+    {
+        trace::enable();
+        trace::complete("parse_args", parse_start, trace::clock::now());
+    }
+
     auto run_output = [&](FileType type)
     {
-        auto cacher = ScopeCacher::create(type, cmake_parser);
+        auto cacher = ScopeCacher::create(type);
         auto gen = Output::create(type);
         return gen.output();
     };
 
-    if (program.is_subcommand_used("cmake"))
+    if (*command == Subcommand::cmake)
+    {
+        bool output_result = run_output(FileType::CMake);
+        if (!(*Args::CMAKE_METRICS).empty() && !metrics::export_to(*Args::CMAKE_METRICS))
+        {
+            log_err("Failed to write metrics to \"{}\".", *Args::CMAKE_METRICS);
+        }
+        if (!(*Args::CMAKE_TRACE).empty() && !trace::export_to(*Args::CMAKE_TRACE))
+        {
+            log_err("Failed to write the trace to \"{}\".", *Args::CMAKE_TRACE);
+        }
+        if (!report_deferred_errors() || !output_result)
+        {
+            return -1;
+        }
+    }
+
+    if (*command == Subcommand::watch)
     {
-        if (!run_output(FileType::CMake))
+        bool watch_result = CMakeWatcher{ std::chrono::milliseconds{ *Args::WATCH_DEBOUNCE } }.run();
+        if (!report_deferred_errors() || !watch_result)
         {
             return -1;
         }
@@ -0,0 +1,117 @@
+#include "manifest.h"
+
+#include <cstring>
+#include <utility>
+
+namespace ft
+{
+namespace
+{
+    // Pages are dropped in steps of it, each step costs an madvise
+    constexpr std::size_t release_step = std::size_t{ 16 } << 20;
+
+    constexpr std::string_view header_field = "directory";
+
+    constexpr bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && is_blank(text.front()))
+        {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && is_blank(text.back()))
+        {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    // Splits off the field before the next comma. Taking the last one leaves `line` null, which tells it apart from
+    // an empty field after a trailing comma
+    std::string_view next_field(std::string_view &line)
+    {
+        if (!line.data())
+        {
+            return {};
+        }
+
+        auto *comma = static_cast<const char *>(std::memchr(line.data(), ',', line.size()));
+        if (!comma)
+        {
+            return trim(std::exchange(line, std::string_view{}));
+        }
+
+        auto length = static_cast<std::size_t>(comma - line.data());
+        std::string_view field = line.substr(0, length);
+        line.remove_prefix(length + 1);
+        return trim(field);
+    }
+} // namespace
+
+FileOpResult<ManifestReader> ManifestReader::open(const std::filesystem::path &path)
+{
+    auto mapped_result = MappedFile::open(path);
+    if (!mapped_result)
+    {
+        return std::unexpected{ std::move(mapped_result.error()) };
+    }
+
+    return ManifestReader{ std::move(mapped_result.value()) };
+}
+
+bool ManifestReader::fail(this ManifestReader &self)
+{
+    self.m_failed = true;
+    self.m_pos = self.m_text.size();
+    return false;
+}
+
+bool ManifestReader::next(this ManifestReader &self, ManifestEntry &entry)
+{
+    std::string_view text = self.m_text;
+    while (self.m_pos < text.size())
+    {
+        if (self.m_pos - self.m_released >= release_step)
+        {
+            self.m_file.release(self.m_pos);
+            self.m_released = self.m_pos;
+        }
+
+        std::size_t begin = self.m_pos;
+        auto *newline = static_cast<const char *>(std::memchr(text.data() + begin, '\n', text.size() - begin));
+        std::size_t end = newline ? static_cast<std::size_t>(newline - text.data()) : text.size();
+        self.m_pos = newline ? end + 1 : end;
+        ++self.m_line;
+
+        std::string_view line = trim(text.substr(begin, end - begin));
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+        if (line.find('"') != std::string_view::npos)
+        {
+            return self.fail();
+        }
+
+        entry.directory = next_field(line);
+        entry.project = next_field(line);
+        entry.config = next_field(line);
+        if (line.data())
+        {
+            return self.fail();
+        }
+        if (self.m_line == 1 && entry.directory == header_field)
+        {
+            continue;
+        }
+        if (entry.directory.empty())
+        {
+            return self.fail();
+        }
+        return true;
+    }
+
+    return false;
+}
+} // namespace ft
\ No newline at end of file
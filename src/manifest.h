@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+#include "file_io.hpp"
+#include "mapped_file.h"
+
+namespace ft
+{
+// One line of a manifest: `directory[,project[,config]]`. Views point into the mapped manifest
+struct ManifestEntry
+{
+    std::string_view directory;
+    // Empty to keep the project name given on the command line
+    std::string_view project;
+    // Empty to keep the options given on the command line and by --use-config
+    std::string_view config;
+};
+
+// Streams the entries of a CSV manifest without copying them. Blank lines and lines starting with '#' are skipped,
+// as is a first line starting with the `directory` header. Fields are trimmed and cannot be quoted. Lines are found
+// with memchr, and the pages already read are dropped as the reader goes, so memory does not grow with the manifest
+class ManifestReader
+{
+public:
+    static FileOpResult<ManifestReader> open(const std::filesystem::path &path);
+
+    // False at the end of the manifest or on a malformed line
+    bool next(this ManifestReader &self, ManifestEntry &entry);
+
+    bool failed(this const ManifestReader &self) { return self.m_failed; }
+
+    // Line of the last entry returned, or of the malformed line, starting from 1
+    std::size_t line(this const ManifestReader &self) { return self.m_line; }
+
+private:
+    explicit ManifestReader(MappedFile file)
+        : m_file(std::move(file))
+        , m_text(m_file.text())
+    {
+    }
+
+    bool fail(this ManifestReader &self);
+
+private:
+    MappedFile m_file;
+    std::string_view m_text;
+    std::size_t m_pos = 0;
+    std::size_t m_line = 0;
+    // Everything before it has been dropped from memory
+    std::size_t m_released = 0;
+    bool m_failed = false;
+};
+} // namespace ft
\ No newline at end of file
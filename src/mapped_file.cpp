@@ -0,0 +1,97 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+
+#ifdef FT_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elifdef FT_PLATFORM_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#error "System not supported."
+#endif
+
+#include "native_file.h"
+
+namespace ft
+{
+FileOpResult<MappedFile> MappedFile::open(const std::filesystem::path &path)
+{
+    native::Handle handle = native::open(path, false);
+    if (handle == native::invalid_handle)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::open_failed, path } };
+    }
+
+    auto size = native::size(handle);
+    if (!size)
+    {
+        native::close(handle);
+        return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, path } };
+    }
+    if (*size == 0)
+    {
+        native::close(handle);
+        return MappedFile{ nullptr, 0 };
+    }
+
+    // The mapping outlives the handle it was created from
+#ifdef FT_PLATFORM_WINDOWS
+    HANDLE mapping = ::CreateFileMappingW(reinterpret_cast<HANDLE>(handle), nullptr, PAGE_READONLY, 0, 0, nullptr);
+    native::close(handle);
+    if (!mapping)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, path } };
+    }
+
+    void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (!data)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, path } };
+    }
+#else
+    void *data = ::mmap(nullptr, static_cast<std::size_t>(*size), PROT_READ, MAP_PRIVATE, static_cast<int>(handle), 0);
+    native::close(handle);
+    if (data == MAP_FAILED)
+    {
+        return std::unexpected{ FileOpErr{ FileOpErrCode::read_failed, path } };
+    }
+    ::madvise(data, static_cast<std::size_t>(*size), MADV_SEQUENTIAL);
+#endif
+
+    return MappedFile{ data, static_cast<std::size_t>(*size) };
+}
+
+void MappedFile::release(this const MappedFile &self, std::size_t end)
+{
+#ifdef FT_PLATFORM_WINDOWS
+    // Clean mapped pages are trimmed from the working set under memory pressure
+    (void)self;
+    (void)end;
+#else
+    static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t length = std::min(end, self.m_size) / page_size * page_size;
+    if (length != 0)
+    {
+        ::madvise(self.m_data, length, MADV_DONTNEED);
+    }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    if (!m_data)
+    {
+        return;
+    }
+
+#ifdef FT_PLATFORM_WINDOWS
+    ::UnmapViewOfFile(m_data);
+#else
+    ::munmap(m_data, m_size);
+#endif
+}
+} // namespace ft
\ No newline at end of file
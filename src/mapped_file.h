@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+#include "file_io.hpp"
+
+namespace ft
+{
+// Read-only view of a whole file mapped into memory, the file can be replaced while it is mapped but must not be
+// truncated in place
+class MappedFile
+{
+public:
+    static FileOpResult<MappedFile> open(const std::filesystem::path &path);
+
+public:
+    MappedFile(MappedFile &&another) noexcept
+        : m_data(std::exchange(another.m_data, nullptr))
+        , m_size(std::exchange(another.m_size, 0))
+    {
+    }
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+
+    ~MappedFile();
+
+    std::string_view text(this const MappedFile &self)
+    {
+        return { static_cast<const char *>(self.m_data), self.m_size };
+    }
+
+    // Drops the pages before `end` from memory once they have been read, they are read again if accessed
+    void release(this const MappedFile &self, std::size_t end);
+
+private:
+    MappedFile(void *data, std::size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+private:
+    // Null for empty files, which cannot be mapped
+    void *m_data;
+    std::size_t m_size;
+};
+} // namespace ft
\ No newline at end of file
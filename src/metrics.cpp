@@ -0,0 +1,394 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_io.hpp"
+
+namespace ft
+{
+namespace metrics
+{
+    namespace
+    {
+        struct MetricInfo
+        {
+            std::string_view name;
+            std::string_view help;
+        };
+
+        constexpr std::array<MetricInfo, static_cast<std::size_t>(Counter::count)> counter_infos{ {
+            { "file_bytes_read", "Bytes read from files." },
+            { "file_bytes_written", "Bytes written to files." },
+            { "file_syscalls", "Read and write system calls on files." },
+            { "file_flushes", "Write buffer flushes." },
+            { "template_cache_hits", "Renders of an already specialized CMakeLists.txt template." },
+            { "template_cache_misses", "Renders that specialized the CMakeLists.txt template first." },
+            { "projects_generated", "Projects generated." },
+        } };
+
+        constexpr std::array<MetricInfo, static_cast<std::size_t>(Timer::count)> timer_infos{ {
+            { "cache_load", "Time to read and parse the config cache." },
+            { "cache_save", "Time to save a config into the cache." },
+            { "render", "Time to render CMakeLists.txt." },
+            { "generate", "Time to generate a project." },
+        } };
+
+        detail::ConfigLookups &find_config(std::vector<detail::ConfigLookups> &configs, std::string_view config)
+        {
+            auto found = std::ranges::find(configs, config, &detail::ConfigLookups::config);
+            if (found == configs.end())
+            {
+                found = configs.insert(configs.end(), detail::ConfigLookups{ std::string{ config }, 0, 0 });
+            }
+            return *found;
+        }
+
+        struct Snapshot
+        {
+            struct Histogram
+            {
+                std::array<std::uint64_t, detail::histogram_buckets> buckets{};
+                std::uint64_t sum = 0;
+                std::uint64_t max = 0;
+
+                std::uint64_t count(this const Histogram &self)
+                {
+                    std::uint64_t count = 0;
+                    for (auto bucket : self.buckets)
+                    {
+                        count += bucket;
+                    }
+                    return count;
+                }
+            };
+
+            std::array<std::uint64_t, static_cast<std::size_t>(Counter::count)> counters{};
+            std::array<std::uint64_t, max_error_codes> errors{};
+            std::array<Histogram, static_cast<std::size_t>(Timer::count)> timers{};
+            // Few configs are looked up per run, kept in lookup order
+            std::vector<detail::ConfigLookups> configs;
+
+            void merge(this Snapshot &self, detail::ThreadMetrics &metrics)
+            {
+                for (std::size_t i = 0; i < self.counters.size(); ++i)
+                {
+                    self.counters[i] += metrics.counters[i].load(std::memory_order_relaxed);
+                }
+                for (std::size_t i = 0; i < self.errors.size(); ++i)
+                {
+                    self.errors[i] += metrics.errors[i].load(std::memory_order_relaxed);
+                }
+                for (std::size_t i = 0; i < self.timers.size(); ++i)
+                {
+                    auto &timer = self.timers[i];
+                    auto &recorded = metrics.timers[i];
+                    for (std::size_t b = 0; b < timer.buckets.size(); ++b)
+                    {
+                        timer.buckets[b] += recorded.buckets[b].load(std::memory_order_relaxed);
+                    }
+                    timer.sum += recorded.sum.load(std::memory_order_relaxed);
+                    timer.max = std::max(timer.max, recorded.max.load(std::memory_order_relaxed));
+                }
+
+                std::lock_guard lock{ metrics.configs_mutex };
+                for (auto &&lookups : metrics.configs)
+                {
+                    auto &merged = find_config(self.configs, lookups.config);
+                    merged.hits += lookups.hits;
+                    merged.misses += lookups.misses;
+                }
+            }
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<detail::ThreadMetrics>> live;
+            // Metrics of the threads that already exited
+            Snapshot retired;
+        };
+
+        const std::chrono::steady_clock::time_point process_start = std::chrono::steady_clock::now();
+
+        Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        // Largest value a bucket holds, in nanoseconds
+        double bucket_upper(std::size_t index)
+        {
+            if (index < detail::sub_buckets)
+            {
+                return static_cast<double>(index);
+            }
+
+            std::size_t shift = index / detail::sub_buckets - 1;
+            std::size_t sub = index % detail::sub_buckets;
+            return std::ldexp(static_cast<double>(detail::sub_buckets + sub + 1), static_cast<int>(shift)) - 1;
+        }
+
+        double seconds(double ns) { return ns / 1e9; }
+
+        // Upper bound of the bucket holding the q-quantile, capped by the largest recorded value
+        double quantile(const Snapshot::Histogram &histogram, std::uint64_t count, double q)
+        {
+            auto target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < histogram.buckets.size(); ++i)
+            {
+                seen += histogram.buckets[i];
+                if (seen != 0 && seen >= target)
+                {
+                    return seconds(std::min(bucket_upper(i), static_cast<double>(histogram.max)));
+                }
+            }
+            return seconds(static_cast<double>(histogram.max));
+        }
+
+        // Valid within JSON strings and Prometheus label values alike
+        std::string escape(std::string_view text)
+        {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '\\':
+                    escaped += "\\\\";
+                    break;
+                case '"':
+                    escaped += "\\\"";
+                    break;
+                case '\n':
+                    escaped += "\\n";
+                    break;
+                default:
+                    escaped += c;
+                    break;
+                }
+            }
+            return escaped;
+        }
+
+        std::string to_prometheus(const Snapshot &snapshot, double run_seconds, double projects_per_second)
+        {
+            std::string text;
+            auto out = std::back_inserter(text);
+
+            for (std::size_t i = 0; i < counter_infos.size(); ++i)
+            {
+                auto [name, help] = counter_infos[i];
+                std::format_to(out, "# HELP filetemp_{0}_total {1}\n# TYPE filetemp_{0}_total counter\n", name, help);
+                std::format_to(out, "filetemp_{}_total {}\n", name, snapshot.counters[i]);
+            }
+
+            text += "# HELP filetemp_file_errors_total File operation errors by kind.\n"
+                    "# TYPE filetemp_file_errors_total counter\n";
+            for (std::size_t i = 0; i < max_error_codes; ++i)
+            {
+                if (auto code = stringify_errcode(static_cast<FileOpErrCode>(i)); !code.empty())
+                {
+                    std::format_to(out, "filetemp_file_errors_total{{code=\"{}\"}} {}\n", code, snapshot.errors[i]);
+                }
+            }
+
+            text += "# HELP filetemp_config_lookups_total Lookups of configs in the config cache.\n"
+                    "# TYPE filetemp_config_lookups_total counter\n";
+            for (auto &&lookups : snapshot.configs)
+            {
+                auto config = escape(lookups.config);
+                std::format_to(
+                    out, "filetemp_config_lookups_total{{config=\"{}\",result=\"hit\"}} {}\n", config, lookups.hits);
+                std::format_to(
+                    out, "filetemp_config_lookups_total{{config=\"{}\",result=\"miss\"}} {}\n", config, lookups.misses);
+            }
+
+            for (std::size_t i = 0; i < timer_infos.size(); ++i)
+            {
+                auto [name, help] = timer_infos[i];
+                auto &histogram = snapshot.timers[i];
+                std::format_to(
+                    out, "# HELP filetemp_{0}_seconds {1}\n# TYPE filetemp_{0}_seconds histogram\n", name, help);
+
+                // Only the buckets that were hit are listed, the others add nothing to the cumulative counts
+                std::uint64_t cumulative = 0;
+                for (std::size_t b = 0; b < histogram.buckets.size(); ++b)
+                {
+                    if (histogram.buckets[b] != 0)
+                    {
+                        cumulative += histogram.buckets[b];
+                        std::format_to(out,
+                                       "filetemp_{}_seconds_bucket{{le=\"{}\"}} {}\n",
+                                       name,
+                                       seconds(bucket_upper(b)),
+                                       cumulative);
+                    }
+                }
+                std::format_to(out, "filetemp_{}_seconds_bucket{{le=\"+Inf\"}} {}\n", name, cumulative);
+                std::format_to(out, "filetemp_{}_seconds_sum {}\n", name, seconds(static_cast<double>(histogram.sum)));
+                std::format_to(out, "filetemp_{}_seconds_count {}\n", name, cumulative);
+            }
+
+            auto now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            std::format_to(out,
+                           "# HELP filetemp_run_seconds Duration of the run.\n"
+                           "# TYPE filetemp_run_seconds gauge\n"
+                           "filetemp_run_seconds {}\n"
+                           "# HELP filetemp_projects_per_second Projects generated per second of the run.\n"
+                           "# TYPE filetemp_projects_per_second gauge\n"
+                           "filetemp_projects_per_second {}\n"
+                           "# HELP filetemp_last_run_timestamp_seconds End of the run as a Unix timestamp.\n"
+                           "# TYPE filetemp_last_run_timestamp_seconds gauge\n"
+                           "filetemp_last_run_timestamp_seconds {}\n",
+                           run_seconds,
+                           projects_per_second,
+                           now);
+            return text;
+        }
+
+        std::string to_json(const Snapshot &snapshot, double run_seconds, double projects_per_second)
+        {
+            std::string text;
+            auto out = std::back_inserter(text);
+            std::format_to(out,
+                           "{{\n  \"run_seconds\": {},\n  \"projects_per_second\": {},\n  \"counters\": {{",
+                           run_seconds,
+                           projects_per_second);
+
+            std::string_view separator = "\n";
+            for (std::size_t i = 0; i < counter_infos.size(); ++i)
+            {
+                std::format_to(out, "{}    \"{}\": {}", separator, counter_infos[i].name, snapshot.counters[i]);
+                separator = ",\n";
+            }
+
+            text += "\n  },\n  \"file_errors\": {";
+            separator = "\n";
+            for (std::size_t i = 0; i < max_error_codes; ++i)
+            {
+                if (auto code = stringify_errcode(static_cast<FileOpErrCode>(i)); !code.empty())
+                {
+                    std::format_to(out, "{}    \"{}\": {}", separator, code, snapshot.errors[i]);
+                    separator = ",\n";
+                }
+            }
+
+            text += "\n  },\n  \"configs\": {";
+            separator = "\n";
+            for (auto &&lookups : snapshot.configs)
+            {
+                std::format_to(out,
+                               "{}    \"{}\": {{ \"hits\": {}, \"misses\": {} }}",
+                               separator,
+                               escape(lookups.config),
+                               lookups.hits,
+                               lookups.misses);
+                separator = ",\n";
+            }
+
+            text += "\n  },\n  \"timers\": {";
+            separator = "\n";
+            for (std::size_t i = 0; i < timer_infos.size(); ++i)
+            {
+                auto &histogram = snapshot.timers[i];
+                std::uint64_t count = histogram.count();
+                std::format_to(out,
+                               "{}    \"{}\": {{ \"count\": {}, \"sum_seconds\": {}, \"p50_seconds\": {}, "
+                               "\"p90_seconds\": {}, \"p99_seconds\": {}, \"max_seconds\": {} }}",
+                               separator,
+                               timer_infos[i].name,
+                               count,
+                               seconds(static_cast<double>(histogram.sum)),
+                               quantile(histogram, count, 0.5),
+                               quantile(histogram, count, 0.9),
+                               quantile(histogram, count, 0.99),
+                               seconds(static_cast<double>(histogram.max)));
+                separator = ",\n";
+            }
+
+            text += "\n  }\n}\n";
+            return text;
+        }
+    } // namespace
+
+    namespace detail
+    {
+        ThreadMetrics *register_thread()
+        {
+            auto &reg = registry();
+            std::lock_guard lock{ reg.mutex };
+            return reg.live.emplace_back(std::make_unique<ThreadMetrics>()).get();
+        }
+
+        void retire_thread(ThreadMetrics *metrics)
+        {
+            auto &reg = registry();
+            std::lock_guard lock{ reg.mutex };
+            reg.retired.merge(*metrics);
+            std::erase_if(reg.live, [&](auto &live) { return live.get() == metrics; });
+        }
+    } // namespace detail
+
+    void count_config(std::string_view config, bool hit)
+    {
+        auto &metrics = detail::local();
+        std::lock_guard lock{ metrics.configs_mutex };
+        auto &lookups = find_config(metrics.configs, config);
+        ++(hit ? lookups.hits : lookups.misses);
+    }
+
+    bool export_to(const std::filesystem::path &path)
+    {
+        auto &reg = registry();
+        auto snapshot = std::make_unique<Snapshot>();
+        double run_seconds = 0;
+        {
+            std::lock_guard lock{ reg.mutex };
+            *snapshot = reg.retired;
+            for (auto &&live : reg.live)
+            {
+                snapshot->merge(*live);
+            }
+            run_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - process_start).count();
+        }
+
+        auto projects = static_cast<double>(snapshot->counters[static_cast<std::size_t>(Counter::projects_generated)]);
+        double projects_per_second = run_seconds > 0 ? projects / run_seconds : 0;
+        std::string text = path.extension() == ".prom"
+                               ? to_prometheus(*snapshot, run_seconds, projects_per_second)
+                               : to_json(*snapshot, run_seconds, projects_per_second);
+
+        auto tmp_path = path;
+        tmp_path += ".tmp";
+        {
+            auto file_create_result = File::create(tmp_path, FileMode::write);
+            if (!file_create_result)
+            {
+                return false;
+            }
+
+            auto &file = file_create_result.value();
+            if (!file.write(std::string_view{ text }) || !file.close())
+            {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, path, ec);
+        return !ec;
+    }
+} // namespace metrics
+} // namespace ft
\ No newline at end of file
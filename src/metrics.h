@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ft
+{
+// Process-wide instrumentation. Each thread records into its own slots without locking or read-modify-write
+// instructions, the slots are only summed when the metrics are exported
+namespace metrics
+{
+    enum class Counter : std::uint8_t
+    {
+        file_bytes_read,
+        file_bytes_written,
+        file_syscalls,
+        file_flushes,
+        template_cache_hits,
+        template_cache_misses,
+        projects_generated,
+        count
+    };
+
+    enum class Timer : std::uint8_t
+    {
+        cache_load,
+        cache_save,
+        render,
+        generate,
+        count
+    };
+
+    // File errors are counted by FileOpErrCode, passed as its value so that file_io.hpp can include this header
+    constexpr std::size_t max_error_codes = 16;
+
+    namespace detail
+    {
+        // Log-linear buckets as in HDR histograms: exact below 8, then 8 linear buckets per power of two, so a
+        // bucket is never wider than 12.5% of the values it holds
+        constexpr std::size_t sub_bucket_bits = 3;
+        constexpr std::size_t sub_buckets = std::size_t{ 1 } << sub_bucket_bits;
+        constexpr std::size_t histogram_buckets = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+        constexpr std::size_t bucket_of(std::uint64_t value)
+        {
+            if (value < sub_buckets)
+            {
+                return static_cast<std::size_t>(value);
+            }
+
+            std::size_t shift = static_cast<std::size_t>(std::bit_width(value)) - 1 - sub_bucket_bits;
+            return (shift + 1) * sub_buckets + static_cast<std::size_t>((value >> shift) & (sub_buckets - 1));
+        }
+
+        struct Histogram
+        {
+            std::array<std::atomic<std::uint64_t>, histogram_buckets> buckets{};
+            std::atomic<std::uint64_t> sum{};
+            std::atomic<std::uint64_t> max{};
+        };
+
+        struct ConfigLookups
+        {
+            std::string config;
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+        };
+
+        struct ThreadMetrics
+        {
+            std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::count)> counters{};
+            std::array<std::atomic<std::uint64_t>, max_error_codes> errors{};
+            std::array<Histogram, static_cast<std::size_t>(Timer::count)> timers{};
+            // Configs are not known up front, so they get a list of their own. Only the owning thread and an export
+            // take the lock, the owner never waits on other threads
+            std::mutex configs_mutex;
+            std::vector<ConfigLookups> configs;
+        };
+
+        ThreadMetrics *register_thread();
+        void retire_thread(ThreadMetrics *metrics);
+
+        // Merges the thread's metrics into the process totals when the thread exits
+        struct ThreadSlot
+        {
+            ThreadMetrics *metrics = register_thread();
+
+            ~ThreadSlot() { retire_thread(metrics); }
+        };
+
+        inline ThreadMetrics &local()
+        {
+            thread_local ThreadSlot slot;
+            return *slot.metrics;
+        }
+
+        // Only the owning thread writes, so a plain load and store is enough
+        inline void bump(std::atomic<std::uint64_t> &slot, std::uint64_t n)
+        {
+            slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    } // namespace detail
+
+    inline void add(Counter counter, std::uint64_t n = 1)
+    {
+        detail::bump(detail::local().counters[static_cast<std::size_t>(counter)], n);
+    }
+
+    inline void count_error(std::size_t code)
+    {
+        if (code < max_error_codes)
+        {
+            detail::bump(detail::local().errors[code], 1);
+        }
+    }
+
+    inline void record(Timer timer, std::chrono::nanoseconds elapsed)
+    {
+        auto ns = static_cast<std::uint64_t>(std::max(elapsed.count(), std::chrono::nanoseconds::rep{ 0 }));
+        auto &histogram = detail::local().timers[static_cast<std::size_t>(timer)];
+        detail::bump(histogram.buckets[detail::bucket_of(ns)], 1);
+        detail::bump(histogram.sum, ns);
+        if (ns > histogram.max.load(std::memory_order_relaxed))
+        {
+            histogram.max.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    // Lookups of a named config in the cache, labeled by config
+    void count_config(std::string_view config, bool hit);
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(Timer timer)
+            : m_timer(timer)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+        ~ScopedTimer() { record(m_timer, std::chrono::steady_clock::now() - m_start); }
+
+    private:
+        Timer m_timer;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Writes a Prometheus textfile if `path` ends in .prom and JSON otherwise, replacing the file atomically so
+    // that a collector never reads it half written
+    bool export_to(const std::filesystem::path &path);
+} // namespace metrics
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,419 @@
+#include "native_file.h"
+
+#ifdef FT_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elifdef FT_PLATFORM_UNIX
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#error "System not supported."
+#endif
+
+#include <algorithm>
+#include <tuple>
+
+#include "metrics.h"
+
+namespace ft
+{
+namespace native
+{
+    namespace
+    {
+        // One read or write system call that moved `bytes`
+        void count_transfer(metrics::Counter counter, std::size_t bytes)
+        {
+            metrics::add(metrics::Counter::file_syscalls);
+            metrics::add(counter, bytes);
+        }
+    } // namespace
+
+#ifdef FT_PLATFORM_WINDOWS
+    namespace
+    {
+        HANDLE to_win(Handle handle) { return reinterpret_cast<HANDLE>(handle); }
+
+        // ReadFile and WriteFile take 32-bit sizes
+        constexpr std::size_t max_chunk = 1u << 30;
+
+        OVERLAPPED overlapped_at(std::uint64_t offset)
+        {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            return overlapped;
+        }
+    } // namespace
+
+    Handle open(const std::filesystem::path &path, bool write)
+    {
+        HANDLE handle = ::CreateFileW(path.c_str(),
+                                      write ? GENERIC_WRITE : GENERIC_READ,
+                                      FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                      nullptr,
+                                      write ? CREATE_ALWAYS : OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL,
+                                      nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return invalid_handle;
+        }
+        return reinterpret_cast<Handle>(handle);
+    }
+
+    void close(Handle handle) { ::CloseHandle(to_win(handle)); }
+
+    Handle open_dir(const std::filesystem::path &path)
+    {
+        HANDLE handle = ::CreateFileW(path.c_str(),
+                                      FILE_LIST_DIRECTORY,
+                                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                      nullptr,
+                                      OPEN_EXISTING,
+                                      FILE_FLAG_BACKUP_SEMANTICS,
+                                      nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return invalid_handle;
+        }
+
+        // Backup semantics open plain files as well
+        BY_HANDLE_FILE_INFORMATION info;
+        if (!::GetFileInformationByHandle(handle, &info) || !(info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        {
+            ::CloseHandle(handle);
+            return invalid_handle;
+        }
+        return reinterpret_cast<Handle>(handle);
+    }
+
+    Handle open_dir_at(Handle, const std::filesystem::path &dir_path, const std::filesystem::path &name)
+    {
+        return open_dir(dir_path / name);
+    }
+
+    Handle open_at(Handle, const std::filesystem::path &dir_path, const std::filesystem::path &name, bool write)
+    {
+        return open(dir_path / name, write);
+    }
+
+    bool make_dir_at(Handle, const std::filesystem::path &dir_path, const std::filesystem::path &name)
+    {
+        return ::CreateDirectoryW((dir_path / name).c_str(), nullptr) || ::GetLastError() == ERROR_ALREADY_EXISTS;
+    }
+
+    bool write_all(Handle handle, std::span<const std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            DWORD written = 0;
+            auto chunk = static_cast<DWORD>(std::min(bytes.size(), max_chunk));
+            if (!::WriteFile(to_win(handle), bytes.data(), chunk, &written, nullptr) || written == 0)
+            {
+                return false;
+            }
+            bytes = bytes.subspan(written);
+            count_transfer(metrics::Counter::file_bytes_written, written);
+        }
+        return true;
+    }
+
+    bool read_all(Handle handle, std::span<std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            DWORD read = 0;
+            auto chunk = static_cast<DWORD>(std::min(bytes.size(), max_chunk));
+            if (!::ReadFile(to_win(handle), bytes.data(), chunk, &read, nullptr) || read == 0)
+            {
+                return false;
+            }
+            bytes = bytes.subspan(read);
+            count_transfer(metrics::Counter::file_bytes_read, read);
+        }
+        return true;
+    }
+
+    bool write_at(Handle handle, std::uint64_t offset, std::span<const std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            DWORD written = 0;
+            auto chunk = static_cast<DWORD>(std::min(bytes.size(), max_chunk));
+            auto overlapped = overlapped_at(offset);
+            if (!::WriteFile(to_win(handle), bytes.data(), chunk, &written, &overlapped) || written == 0)
+            {
+                return false;
+            }
+            bytes = bytes.subspan(written);
+            count_transfer(metrics::Counter::file_bytes_written, written);
+            offset += written;
+        }
+        return true;
+    }
+
+    bool read_at(Handle handle, std::uint64_t offset, std::span<std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            DWORD read = 0;
+            auto chunk = static_cast<DWORD>(std::min(bytes.size(), max_chunk));
+            auto overlapped = overlapped_at(offset);
+            if (!::ReadFile(to_win(handle), bytes.data(), chunk, &read, &overlapped) || read == 0)
+            {
+                return false;
+            }
+            bytes = bytes.subspan(read);
+            count_transfer(metrics::Counter::file_bytes_read, read);
+            offset += read;
+        }
+        return true;
+    }
+
+    std::optional<std::uint64_t> size(Handle handle)
+    {
+        LARGE_INTEGER file_size;
+        if (!::GetFileSizeEx(to_win(handle), &file_size))
+        {
+            return std::nullopt;
+        }
+        return static_cast<std::uint64_t>(file_size.QuadPart);
+    }
+
+    bool reserve(Handle handle, std::uint64_t size)
+    {
+        FILE_ALLOCATION_INFO info{};
+        info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+        return ::SetFileInformationByHandle(to_win(handle), FileAllocationInfo, &info, sizeof(info)) != FALSE;
+    }
+
+    bool skip_zeros(Handle handle, std::uint64_t count)
+    {
+        LARGE_INTEGER zero{};
+        LARGE_INTEGER position;
+        LARGE_INTEGER file_size;
+        if (!::SetFilePointerEx(to_win(handle), zero, &position, FILE_CURRENT) ||
+            !::GetFileSizeEx(to_win(handle), &file_size) || position.QuadPart < file_size.QuadPart)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER target;
+        target.QuadPart = position.QuadPart + static_cast<LONGLONG>(count);
+        if (!::SetFilePointerEx(to_win(handle), target, nullptr, FILE_BEGIN))
+        {
+            return false;
+        }
+        if (!::SetEndOfFile(to_win(handle)))
+        {
+            ::SetFilePointerEx(to_win(handle), position, nullptr, FILE_BEGIN);
+            return false;
+        }
+        return true;
+    }
+
+    void advise(Handle, AccessHint) {}
+#else
+    namespace
+    {
+        Handle open_fd_at(int dir, const char *path, int flags)
+        {
+            int fd;
+            do
+            {
+                fd = ::openat(dir, path, flags | O_CLOEXEC, 0666);
+            } while (fd < 0 && errno == EINTR);
+
+            return fd < 0 ? invalid_handle : fd;
+        }
+
+        int file_flags(bool write) { return write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY; }
+    } // namespace
+
+    Handle open(const std::filesystem::path &path, bool write)
+    {
+        return open_fd_at(AT_FDCWD, path.c_str(), file_flags(write));
+    }
+
+    void close(Handle handle) { ::close(static_cast<int>(handle)); }
+
+    Handle open_dir(const std::filesystem::path &path)
+    {
+        return open_fd_at(AT_FDCWD, path.c_str(), O_RDONLY | O_DIRECTORY);
+    }
+
+    Handle open_dir_at(Handle dir, const std::filesystem::path &, const std::filesystem::path &name)
+    {
+        return open_fd_at(static_cast<int>(dir), name.c_str(), O_RDONLY | O_DIRECTORY);
+    }
+
+    Handle open_at(Handle dir, const std::filesystem::path &, const std::filesystem::path &name, bool write)
+    {
+        return open_fd_at(static_cast<int>(dir), name.c_str(), file_flags(write));
+    }
+
+    bool make_dir_at(Handle dir, const std::filesystem::path &, const std::filesystem::path &name)
+    {
+        return ::mkdirat(static_cast<int>(dir), name.c_str(), 0777) == 0 || errno == EEXIST;
+    }
+
+    bool write_all(Handle handle, std::span<const std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            auto written = ::write(static_cast<int>(handle), bytes.data(), bytes.size());
+            if (written <= 0)
+            {
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            bytes = bytes.subspan(static_cast<std::size_t>(written));
+            count_transfer(metrics::Counter::file_bytes_written, static_cast<std::size_t>(written));
+        }
+        return true;
+    }
+
+    bool read_all(Handle handle, std::span<std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            auto read = ::read(static_cast<int>(handle), bytes.data(), bytes.size());
+            if (read <= 0)
+            {
+                if (read < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            bytes = bytes.subspan(static_cast<std::size_t>(read));
+            count_transfer(metrics::Counter::file_bytes_read, static_cast<std::size_t>(read));
+        }
+        return true;
+    }
+
+    bool write_at(Handle handle, std::uint64_t offset, std::span<const std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            auto written =
+                ::pwrite(static_cast<int>(handle), bytes.data(), bytes.size(), static_cast<off_t>(offset));
+            if (written <= 0)
+            {
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            bytes = bytes.subspan(static_cast<std::size_t>(written));
+            count_transfer(metrics::Counter::file_bytes_written, static_cast<std::size_t>(written));
+            offset += static_cast<std::uint64_t>(written);
+        }
+        return true;
+    }
+
+    bool read_at(Handle handle, std::uint64_t offset, std::span<std::byte> bytes)
+    {
+        while (!bytes.empty())
+        {
+            auto read = ::pread(static_cast<int>(handle), bytes.data(), bytes.size(), static_cast<off_t>(offset));
+            if (read <= 0)
+            {
+                if (read < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            bytes = bytes.subspan(static_cast<std::size_t>(read));
+            count_transfer(metrics::Counter::file_bytes_read, static_cast<std::size_t>(read));
+            offset += static_cast<std::uint64_t>(read);
+        }
+        return true;
+    }
+
+    std::optional<std::uint64_t> size(Handle handle)
+    {
+        struct stat st;
+        if (::fstat(static_cast<int>(handle), &st) != 0)
+        {
+            return std::nullopt;
+        }
+        return static_cast<std::uint64_t>(st.st_size);
+    }
+
+    bool reserve([[maybe_unused]] Handle handle, [[maybe_unused]] std::uint64_t size)
+    {
+#ifdef __linux__
+        if (::fallocate(static_cast<int>(handle), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) != 0)
+        {
+            return errno == EOPNOTSUPP || errno == ENOSYS;
+        }
+#endif
+        return true;
+    }
+
+    bool skip_zeros(Handle handle, std::uint64_t count)
+    {
+        int fd = static_cast<int>(handle);
+        struct stat st;
+        off_t position = ::lseek(fd, 0, SEEK_CUR);
+        if (position < 0 || ::fstat(fd, &st) != 0 || position < st.st_size)
+        {
+            return false;
+        }
+
+        // Extending the size leaves the skipped range unallocated, it reads back as zeros
+        off_t target = position + static_cast<off_t>(count);
+        if (::ftruncate(fd, target) != 0)
+        {
+            return false;
+        }
+        if (::lseek(fd, target, SEEK_SET) != target)
+        {
+            std::ignore = ::ftruncate(fd, position);
+            return false;
+        }
+        return true;
+    }
+
+    void advise([[maybe_unused]] Handle handle, [[maybe_unused]] AccessHint hint)
+    {
+#ifdef POSIX_FADV_NORMAL
+        int advice = POSIX_FADV_NORMAL;
+        switch (hint)
+        {
+        case AccessHint::normal:
+            advice = POSIX_FADV_NORMAL;
+            break;
+        case AccessHint::sequential:
+            advice = POSIX_FADV_SEQUENTIAL;
+            break;
+        case AccessHint::random:
+            advice = POSIX_FADV_RANDOM;
+            break;
+        case AccessHint::once:
+            advice = POSIX_FADV_NOREUSE;
+            break;
+        default:
+            break;
+        }
+        ::posix_fadvise(static_cast<int>(handle), 0, 0, advice);
+#endif
+    }
+#endif
+} // namespace native
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace ft
+{
+enum class AccessHint
+{
+    normal,
+    sequential,
+    random,
+    once
+};
+
+// Thin layer over the platform's file descriptors, File is built on top of it
+namespace native
+{
+    using Handle = std::intptr_t;
+
+    inline constexpr Handle invalid_handle = -1;
+
+    // Opened handles are never inherited by child processes
+    Handle open(const std::filesystem::path &path, bool write);
+    void close(Handle handle);
+
+    // Directory handles, children are resolved relative to them with the *at calls. Windows has none of those,
+    // there `dir_path` names the directory and the handle only keeps it from being removed
+    Handle open_dir(const std::filesystem::path &path);
+    Handle open_dir_at(Handle dir, const std::filesystem::path &dir_path, const std::filesystem::path &name);
+    Handle open_at(Handle dir, const std::filesystem::path &dir_path, const std::filesystem::path &name, bool write);
+
+    // True if the directory was created or something with that name already exists
+    bool make_dir_at(Handle dir, const std::filesystem::path &dir_path, const std::filesystem::path &name);
+
+    // Transfers the whole span, retrying on partial transfers and interruptions
+    bool write_all(Handle handle, std::span<const std::byte> bytes);
+    bool read_all(Handle handle, std::span<std::byte> bytes);
+
+    // Positional transfers leave the sequential position untouched on POSIX, on Windows they move it
+    bool write_at(Handle handle, std::uint64_t offset, std::span<const std::byte> bytes);
+    bool read_at(Handle handle, std::uint64_t offset, std::span<std::byte> bytes);
+
+    std::optional<std::uint64_t> size(Handle handle);
+
+    // Allocates storage for the first `size` bytes without changing the file size, true if unsupported
+    bool reserve(Handle handle, std::uint64_t size);
+
+    // Advances the position by `count` zero bytes without writing them, leaving a hole where the file system
+    // supports one. Only possible at the end of the file, false otherwise
+    bool skip_zeros(Handle handle, std::uint64_t count);
+
+    // Best effort, unsupported hints are ignored
+    void advise(Handle handle, AccessHint hint);
+} // namespace native
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ft
+{
+// Template with std::format style "{N}" slots and "{{" "}}" escapes, whose slots can be bound in stages. Binding
+// some slots folds their values into the literal text and leaves a specialized template with the remaining holes
+class PartialTemplate
+{
+public:
+    static std::optional<PartialTemplate> parse(std::string_view text)
+    {
+        PartialTemplate ret;
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            char c = text[i];
+            if ((c == '{' || c == '}') && i + 1 < text.size() && text[i + 1] == c)
+            {
+                ret.m_literal += c;
+                ++i;
+                continue;
+            }
+            if (c == '}')
+            {
+                return std::nullopt;
+            }
+            if (c != '{')
+            {
+                ret.m_literal += c;
+                continue;
+            }
+
+            std::size_t slot = 0;
+            std::size_t digits = 0;
+            for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits)
+            {
+                slot = slot * 10 + static_cast<std::size_t>(text[i] - '0');
+            }
+            if (digits == 0 || i == text.size() || text[i] != '}')
+            {
+                return std::nullopt;
+            }
+            ret.m_holes.push_back({ ret.m_literal.size(), slot });
+        }
+        return ret;
+    }
+
+    // Slots with a value are folded into the literal text, the others stay holes
+    PartialTemplate bind(this const PartialTemplate &self, std::span<const std::optional<std::string_view>> values)
+    {
+        PartialTemplate ret;
+        ret.m_literal.reserve(self.bound_size(values));
+
+        std::size_t pos = 0;
+        for (auto &&hole : self.m_holes)
+        {
+            ret.m_literal.append(self.m_literal, pos, hole.pos - pos);
+            pos = hole.pos;
+            if (hole.slot < values.size() && values[hole.slot])
+            {
+                ret.m_literal += *values[hole.slot];
+            }
+            else
+            {
+                ret.m_holes.push_back({ ret.m_literal.size(), hole.slot });
+            }
+        }
+        ret.m_literal.append(self.m_literal, pos);
+        return ret;
+    }
+
+    // Fills every hole in a single pass, the output is sized up front. Holes without a value are left empty
+    void render_into(this const PartialTemplate &self, std::string &out, std::span<const std::string_view> values)
+    {
+        std::size_t size = self.m_literal.size();
+        for (auto &&hole : self.m_holes)
+        {
+            size += hole.slot < values.size() ? values[hole.slot].size() : 0;
+        }
+        out.reserve(out.size() + size);
+
+        std::size_t pos = 0;
+        for (auto &&hole : self.m_holes)
+        {
+            out.append(self.m_literal, pos, hole.pos - pos);
+            pos = hole.pos;
+            if (hole.slot < values.size())
+            {
+                out += values[hole.slot];
+            }
+        }
+        out.append(self.m_literal, pos);
+    }
+
+    std::string render(this const PartialTemplate &self, std::span<const std::string_view> values)
+    {
+        std::string out;
+        self.render_into(out, values);
+        return out;
+    }
+
+    // Source form, parse() reads it back into an equal template
+    std::string text(this const PartialTemplate &self)
+    {
+        std::string out;
+        out.reserve(self.m_literal.size() + self.m_holes.size() * 4);
+
+        auto append_escaped = [&](std::size_t from, std::size_t to)
+        {
+            for (std::size_t i = from; i < to; ++i)
+            {
+                char c = self.m_literal[i];
+                out += c;
+                if (c == '{' || c == '}')
+                {
+                    out += c;
+                }
+            }
+        };
+
+        std::size_t pos = 0;
+        for (auto &&hole : self.m_holes)
+        {
+            append_escaped(pos, hole.pos);
+            pos = hole.pos;
+            out += '{';
+            out += std::to_string(hole.slot);
+            out += '}';
+        }
+        append_escaped(pos, self.m_literal.size());
+        return out;
+    }
+
+private:
+    struct Hole
+    {
+        // Offset into m_literal the slot's value is inserted at
+        std::size_t pos;
+        std::size_t slot;
+    };
+
+    std::size_t bound_size(this const PartialTemplate &self,
+                           std::span<const std::optional<std::string_view>> values)
+    {
+        std::size_t size = self.m_literal.size();
+        for (auto &&hole : self.m_holes)
+        {
+            if (hole.slot < values.size() && values[hole.slot])
+            {
+                size += values[hole.slot]->size();
+            }
+        }
+        return size;
+    }
+
+private:
+    std::string m_literal;
+    std::vector<Hole> m_holes;
+};
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+#include "checksum.h"
+
+namespace ft
+{
+template <typename T>
+concept FixedWidth = (std::is_integral_v<T> || std::is_enum_v<T> || std::is_floating_point_v<T>) &&
+                     !std::same_as<T, bool> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+namespace detail
+{
+    template <std::size_t Size>
+    using UintOf = std::conditional_t<
+        Size == 1,
+        std::uint8_t,
+        std::conditional_t<Size == 2, std::uint16_t, std::conditional_t<Size == 4, std::uint32_t, std::uint64_t>>>;
+
+    template <std::unsigned_integral U>
+    constexpr U swap_to_little(U value)
+    {
+        if constexpr (std::endian::native == std::endian::little || sizeof(U) == 1)
+        {
+            return value;
+        }
+        else
+        {
+            return std::byteswap(value);
+        }
+    }
+
+    template <FixedWidth T>
+    constexpr auto to_little_bits(T value)
+    {
+        return swap_to_little(std::bit_cast<UintOf<sizeof(T)>>(value));
+    }
+
+    template <FixedWidth T>
+    constexpr T from_little_bits(UintOf<sizeof(T)> bits)
+    {
+        return std::bit_cast<T>(swap_to_little(bits));
+    }
+} // namespace detail
+
+// Little-endian value without alignment requirement or padding, safe to read straight out of a mapped file
+template <FixedWidth T>
+struct LittleEndian
+{
+    std::array<std::byte, sizeof(T)> bytes{};
+
+    constexpr LittleEndian() = default;
+    constexpr LittleEndian(T value) { bytes = std::bit_cast<decltype(bytes)>(detail::to_little_bits(value)); }
+
+    constexpr T get(this const LittleEndian &self)
+    {
+        return detail::from_little_bits<T>(std::bit_cast<detail::UintOf<sizeof(T)>>(self.bytes));
+    }
+    constexpr operator T(this const LittleEndian &self) { return self.get(); }
+};
+
+// Converts between host and little-endian order in place, a no-op on little-endian hosts. The loop is
+// kept trivial so that compilers turn it into vector byte shuffles
+template <FixedWidth T, std::size_t Extent>
+void to_little_endian(std::span<T, Extent> values)
+{
+    if constexpr (std::endian::native != std::endian::little && sizeof(T) > 1)
+    {
+        using U = detail::UintOf<sizeof(T)>;
+        for (auto &&value : values)
+        {
+            value = std::bit_cast<T>(std::byteswap(std::bit_cast<U>(value)));
+        }
+    }
+}
+
+template <FixedWidth T, std::size_t Extent>
+void from_little_endian(std::span<T, Extent> values)
+{
+    to_little_endian(values);
+}
+
+// Schema element inserting zero bytes up to the next multiple of N
+template <std::size_t N>
+    requires(std::has_single_bit(N))
+struct Align
+{
+    static constexpr std::size_t value = N;
+};
+
+template <std::size_t N>
+inline constexpr Align<N> align{};
+
+// A type describes its encoding with a tuple of member pointers and Align markers, for example
+//     static constexpr auto schema = std::tuple{ &Foo::id, ft::align<8>, &Foo::offsets };
+// Members may be fixed-width scalars or std::arrays of them, they are encoded little-endian in order.
+template <typename T>
+concept SchemaSerializable = requires { std::tuple_size<std::remove_cvref_t<decltype(T::schema)>>::value; };
+
+namespace detail
+{
+    template <typename T>
+    struct SchemaField
+    {
+    };
+
+    template <typename C, FixedWidth M>
+    struct SchemaField<M C::*>
+    {
+        using value_type = M;
+        static constexpr std::size_t count = 1;
+    };
+
+    template <typename C, FixedWidth M, std::size_t N>
+    struct SchemaField<std::array<M, N> C::*>
+    {
+        using value_type = M;
+        static constexpr std::size_t count = N;
+    };
+
+    constexpr std::size_t align_up(std::size_t offset, std::size_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    template <typename F>
+    constexpr std::size_t advance(std::size_t offset, F)
+    {
+        if constexpr (requires { F::value; })
+        {
+            return align_up(offset, F::value);
+        }
+        else
+        {
+            return offset + sizeof(typename SchemaField<F>::value_type) * SchemaField<F>::count;
+        }
+    }
+
+    template <typename T, typename F>
+    void encode_field(const T &obj, F field, std::span<std::byte> out, std::size_t offset)
+    {
+        if constexpr (requires { F::value; })
+        {
+            std::memset(out.data() + offset, 0, align_up(offset, F::value) - offset);
+        }
+        else
+        {
+            using V = typename SchemaField<F>::value_type;
+            const V *values = [&]
+            {
+                if constexpr (SchemaField<F>::count == 1)
+                {
+                    return &(obj.*field);
+                }
+                else
+                {
+                    return (obj.*field).data();
+                }
+            }();
+
+            for (std::size_t i = 0; i < SchemaField<F>::count; ++i)
+            {
+                auto bits = to_little_bits(values[i]);
+                std::memcpy(out.data() + offset + i * sizeof(V), &bits, sizeof(V));
+            }
+        }
+    }
+
+    template <typename T, typename F>
+    void decode_field(T &obj, F field, std::span<const std::byte> in, std::size_t offset)
+    {
+        if constexpr (!requires { F::value; })
+        {
+            using V = typename SchemaField<F>::value_type;
+            V *values = [&]
+            {
+                if constexpr (SchemaField<F>::count == 1)
+                {
+                    return &(obj.*field);
+                }
+                else
+                {
+                    return (obj.*field).data();
+                }
+            }();
+
+            for (std::size_t i = 0; i < SchemaField<F>::count; ++i)
+            {
+                UintOf<sizeof(V)> bits;
+                std::memcpy(&bits, in.data() + offset + i * sizeof(V), sizeof(V));
+                values[i] = from_little_bits<V>(bits);
+            }
+        }
+    }
+} // namespace detail
+
+// Encoded size of T, fixed at compile time and independent of the host's padding and byte order
+template <SchemaSerializable T>
+consteval std::size_t schema_size()
+{
+    std::size_t offset = 0;
+    std::apply([&](auto... fields) { ((offset = detail::advance(offset, fields)), ...); }, T::schema);
+    return offset;
+}
+
+// `out` must hold at least schema_size<T>() bytes
+template <SchemaSerializable T>
+void schema_encode(const T &obj, std::span<std::byte> out)
+{
+    std::size_t offset = 0;
+    std::apply(
+        [&](auto... fields)
+        {
+            ((detail::encode_field(obj, fields, out, offset), offset = detail::advance(offset, fields)), ...);
+        },
+        T::schema);
+}
+
+// `in` must hold at least schema_size<T>() bytes
+template <SchemaSerializable T>
+void schema_decode(T &obj, std::span<const std::byte> in)
+{
+    std::size_t offset = 0;
+    std::apply(
+        [&](auto... fields)
+        { ((detail::decode_field(obj, fields, in, offset), offset = detail::advance(offset, fields)), ...); },
+        T::schema);
+}
+
+// Makes a schema type writable and readable through File
+template <typename Derived>
+struct SchemaRecord
+{
+    std::size_t serialized_size(this const Derived &) { return schema_size<Derived>(); }
+    void serialize_into(this const Derived &self, std::span<std::byte> out) { schema_encode(self, out); }
+    void deserialize(this Derived &self, std::span<std::byte> in) { schema_decode(self, in); }
+};
+
+// Versioned header in front of binary payloads, padded so that the payload starts 8-byte aligned
+struct BinaryHeader : SchemaRecord<BinaryHeader>
+{
+    std::uint32_t magic = 0;
+    std::uint16_t version = 0;
+    std::uint16_t header_size = 0;
+    std::uint64_t payload_size = 0;
+    std::uint32_t checksum = 0;
+
+    static constexpr auto schema = std::tuple{ &BinaryHeader::magic,
+                                               &BinaryHeader::version,
+                                               &BinaryHeader::header_size,
+                                               &BinaryHeader::payload_size,
+                                               &BinaryHeader::checksum,
+                                               align<8> };
+
+    static std::uint32_t checksum_of(std::span<const std::byte> payload)
+    {
+        return crc32c(payload);
+    }
+
+    static BinaryHeader make(std::uint32_t magic_, std::uint16_t version_, std::span<const std::byte> payload)
+    {
+        BinaryHeader header;
+        header.magic = magic_;
+        header.version = version_;
+        header.header_size = static_cast<std::uint16_t>(schema_size<BinaryHeader>());
+        header.payload_size = payload.size();
+        header.checksum = checksum_of(payload);
+        return header;
+    }
+
+    // Whether the header describes `payload` as a file of the expected kind and version
+    bool verify(this const BinaryHeader &self,
+                std::uint32_t magic_,
+                std::uint16_t version_,
+                std::span<const std::byte> payload)
+    {
+        return self.magic == magic_ && self.version == version_ &&
+               self.header_size == schema_size<BinaryHeader>() && self.payload_size == payload.size() &&
+               self.checksum == checksum_of(payload);
+    }
+};
+} // namespace ft
\ No newline at end of file
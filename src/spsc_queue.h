@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace ft
+{
+// Bounded ring between one producer and one consumer thread, without locks. Each end only writes its own index,
+// and blocks on a shared event counter while the ring is full or empty, so an idle end sleeps instead of spinning
+template <typename T>
+class SpscQueue
+{
+public:
+    // Rounded up to a power of two
+    explicit SpscQueue(std::size_t capacity)
+        : m_slots(std::bit_ceil(capacity))
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    std::size_t capacity(this const SpscQueue &self) { return self.m_slots.size(); }
+
+    // Producer only, blocks while the queue is full
+    void push(this SpscQueue &self, T value)
+    {
+        std::size_t tail = self.m_tail.load(std::memory_order_relaxed);
+        self.wait_until([&] { return tail - self.m_head.load(std::memory_order_acquire) < self.m_slots.size(); });
+        self.m_slots[tail & (self.m_slots.size() - 1)] = std::move(value);
+        self.m_tail.store(tail + 1, std::memory_order_release);
+        self.signal();
+    }
+
+    // Consumer only, blocks while the queue is empty. Nullopt once it is closed and drained
+    std::optional<T> pop(this SpscQueue &self)
+    {
+        std::size_t head = self.m_head.load(std::memory_order_relaxed);
+        self.wait_until([&] { return self.m_tail.load(std::memory_order_acquire) != head || self.m_closed.load(); });
+        return self.take(head);
+    }
+
+    // Consumer only, nullopt if the queue is empty
+    std::optional<T> try_pop(this SpscQueue &self) { return self.take(self.m_head.load(std::memory_order_relaxed)); }
+
+    // Producer only, the consumer still receives what was pushed before
+    void close(this SpscQueue &self)
+    {
+        self.m_closed.store(true);
+        self.signal();
+    }
+
+private:
+    std::optional<T> take(this SpscQueue &self, std::size_t head)
+    {
+        if (self.m_tail.load(std::memory_order_acquire) == head)
+        {
+            return std::nullopt;
+        }
+
+        std::optional<T> value{ std::move(self.m_slots[head & (self.m_slots.size() - 1)]) };
+        self.m_head.store(head + 1, std::memory_order_release);
+        self.signal();
+        return value;
+    }
+
+    // The counter is read before the condition, so a change made after the check also changes the counter. The
+    // other end only wakes sleepers it can see, and either it sees this one or this one sees its new count
+    template <typename F>
+    void wait_until(this SpscQueue &self, F &&ready)
+    {
+        while (true)
+        {
+            std::uint32_t event = self.m_event.load();
+            if (ready())
+            {
+                return;
+            }
+
+            self.m_sleepers.fetch_add(1);
+            self.m_event.wait(event);
+            self.m_sleepers.fetch_sub(1);
+        }
+    }
+
+    // Waking is a system call, skipped while the other end is running
+    void signal(this SpscQueue &self)
+    {
+        self.m_event.fetch_add(1);
+        if (self.m_sleepers.load() != 0)
+        {
+            self.m_event.notify_all();
+        }
+    }
+
+private:
+    static constexpr std::size_t cache_line = 64;
+
+    std::vector<T> m_slots;
+    // Apart, so that moving one index does not invalidate the line the other end reads its own index from
+    alignas(cache_line) std::atomic<std::size_t> m_head{ 0 };
+    alignas(cache_line) std::atomic<std::size_t> m_tail{ 0 };
+    alignas(cache_line) std::atomic<std::uint32_t> m_event{ 0 };
+    std::atomic<std::uint32_t> m_sleepers{ 0 };
+    std::atomic<bool> m_closed{ false };
+};
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "embedded_templates.h"
+
+namespace ft
+{
+enum class SourceLang : std::uint8_t
+{
+    C,
+    CXX,
+    count
+};
+
+struct SourceTemplate
+{
+    std::string_view filename;
+    std::string_view content;
+    // Standard headers the source includes, precompiled when requested
+    std::string_view headers;
+    // Variant that uses import std when the build defines USE_IMPORT_STD, empty if there is none
+    std::string_view modular;
+    // Google Benchmark sample, always C++ since the library is
+    std::string_view bench;
+    // Profiling zone macros, written to src/profile.h
+    std::string_view profile;
+};
+
+namespace detail
+{
+    struct SourceVariant
+    {
+        SourceLang lang;
+        // First standard the variant applies to, it is used for all later standards until the next variant
+        int since;
+        SourceTemplate source;
+    };
+
+    // Template files live in templates/ and are embedded at build time by cmake/embed_templates.cmake
+    inline constexpr std::array source_variants{
+        SourceVariant{ SourceLang::C,
+                       89,
+                       { "main.c",
+                         embedded::c_main_c,
+                         "<stdio.h>",
+                         {},
+                         embedded::bench_bench_c_cpp,
+                         embedded::profile_profile_c_h } },
+        SourceVariant{ SourceLang::CXX,
+                       98,
+                       { "main.cpp",
+                         embedded::cxx_main_cpp,
+                         "<iostream>",
+                         {},
+                         embedded::bench_bench_cpp,
+                         embedded::profile_profile_h } },
+        SourceVariant{ SourceLang::CXX,
+                       20,
+                       { "main.cpp",
+                         embedded::cxx_main_cpp,
+                         "<iostream>",
+                         {},
+                         embedded::bench_bench_20_cpp,
+                         embedded::profile_profile_h } },
+        SourceVariant{ SourceLang::CXX,
+                       23,
+                       { "main.cpp",
+                         embedded::cxx_main_23_cpp,
+                         "<print>",
+                         embedded::cxx_main_23_module_cpp,
+                         embedded::bench_bench_20_cpp,
+                         embedded::profile_profile_h } },
+    };
+
+    // Every standard CMake accepts for the language, by two-digit year
+    inline constexpr std::array c_standards{ 90, 99, 11, 17, 23 };
+    inline constexpr std::array cxx_standards{ 98, 11, 14, 17, 20, 23, 26 };
+
+    // Standards are named by two-digit years, 89 and 98 come before 11
+    constexpr int standard_year(int standard)
+    {
+        return standard >= 80 ? 1900 + standard : 2000 + standard;
+    }
+
+    using SourceTable = std::array<std::array<SourceTemplate, 100>, static_cast<std::size_t>(SourceLang::count)>;
+
+    // Resolves every (language, two-digit standard) pair up front, standards older than every variant use the
+    // language's oldest one
+    consteval SourceTable make_source_table()
+    {
+        SourceTable table{};
+        for (std::size_t lang = 0; lang < table.size(); ++lang)
+        {
+            for (int standard = 0; standard < 100; ++standard)
+            {
+                const SourceVariant *best = nullptr;
+                const SourceVariant *oldest = nullptr;
+                for (auto &&variant : source_variants)
+                {
+                    if (static_cast<std::size_t>(variant.lang) != lang)
+                    {
+                        continue;
+                    }
+                    if (!oldest || standard_year(variant.since) < standard_year(oldest->since))
+                    {
+                        oldest = &variant;
+                    }
+                    if (standard_year(variant.since) <= standard_year(standard) &&
+                        (!best || standard_year(variant.since) > standard_year(best->since)))
+                    {
+                        best = &variant;
+                    }
+                }
+
+                if (best || oldest)
+                {
+                    table[lang][standard] = (best ? best : oldest)->source;
+                }
+            }
+        }
+        return table;
+    }
+
+    inline constexpr SourceTable source_table = make_source_table();
+} // namespace detail
+
+constexpr std::span<const int> known_standards(SourceLang lang)
+{
+    if (lang == SourceLang::C)
+    {
+        return detail::c_standards;
+    }
+    return detail::cxx_standards;
+}
+
+// Nullopt for a standard CMake does not know, such as 2023 instead of 23
+constexpr std::optional<SourceTemplate> source_template(SourceLang lang, int standard)
+{
+    auto standards = known_standards(lang);
+    if (std::ranges::find(standards, standard) == standards.end())
+    {
+        return std::nullopt;
+    }
+    return detail::source_table[static_cast<std::size_t>(lang)][static_cast<std::size_t>(standard)];
+}
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "trace.h"
+
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "file_io.hpp"
+
+namespace ft
+{
+namespace trace
+{
+    namespace
+    {
+        struct Registry
+        {
+            std::mutex mutex;
+            // Kept after their threads exit, so that their events are still exported
+            std::vector<std::unique_ptr<detail::ThreadBuffer>> buffers;
+        };
+
+        Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        // Timestamps are exported relative to it
+        const clock::time_point process_start = clock::now();
+
+        double micros(clock::duration duration)
+        {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        }
+    } // namespace
+
+    namespace detail
+    {
+        ThreadBuffer *register_thread()
+        {
+            auto &reg = registry();
+            std::lock_guard lock{ reg.mutex };
+            auto tid = static_cast<std::uint32_t>(reg.buffers.size());
+            return reg.buffers.emplace_back(std::make_unique<ThreadBuffer>(tid, std::vector<Event>{})).get();
+        }
+    } // namespace detail
+
+    bool export_to(const std::filesystem::path &path)
+    {
+        std::string text = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        auto out = std::back_inserter(text);
+        {
+            auto &reg = registry();
+            std::lock_guard lock{ reg.mutex };
+            std::string_view separator = "";
+            for (auto &&buffer : reg.buffers)
+            {
+                std::format_to(out,
+                               "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+                               "\"args\":{{\"name\":\"{}\"}}}}",
+                               separator,
+                               buffer->tid,
+                               buffer->tid == 0 ? "main" : std::format("thread {}", buffer->tid));
+                separator = ",\n";
+
+                for (auto &&event : buffer->events)
+                {
+                    std::format_to(out,
+                                   ",\n{{\"name\":\"{}\",\"cat\":\"filetemp\",\"ph\":\"X\",\"pid\":1,\"tid\":{},"
+                                   "\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                                   event.name,
+                                   buffer->tid,
+                                   micros(event.start - process_start),
+                                   micros(event.duration));
+                }
+            }
+        }
+        text += "\n]}\n";
+
+        auto tmp_path = path;
+        tmp_path += ".tmp";
+        {
+            auto file_create_result = File::create(tmp_path, FileMode::write);
+            if (!file_create_result)
+            {
+                return false;
+            }
+
+            auto &file = file_create_result.value();
+            if (!file.write(std::string_view{ text }) || !file.close())
+            {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, path, ec);
+        return !ec;
+    }
+} // namespace trace
+} // namespace ft
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace ft
+{
+// Scoped events in the Chrome trace event format, viewable in Perfetto. Each thread appends to its own buffer,
+// the buffers are only read by export_to() once the traced threads are done. While tracing is off a scope costs
+// a relaxed load and a branch
+namespace trace
+{
+    using clock = std::chrono::steady_clock;
+
+    namespace detail
+    {
+        inline std::atomic<bool> s_enabled{ false };
+
+        struct Event
+        {
+            // Names are string literals, they are never copied
+            std::string_view name;
+            clock::time_point start;
+            clock::duration duration;
+        };
+
+        struct ThreadBuffer
+        {
+            std::uint32_t tid;
+            std::vector<Event> events;
+        };
+
+        ThreadBuffer *register_thread();
+
+        inline ThreadBuffer &local()
+        {
+            thread_local ThreadBuffer *buffer = register_thread();
+            return *buffer;
+        }
+    } // namespace detail
+
+    inline bool enabled() { return detail::s_enabled.load(std::memory_order_relaxed); }
+
+    inline void enable() { detail::s_enabled.store(true, std::memory_order_relaxed); }
+
+    // Records a span measured before tracing could be enabled, e.g. the parsing of the option enabling it
+    inline void complete(std::string_view name, clock::time_point start, clock::time_point end)
+    {
+        if (enabled())
+        {
+            detail::local().events.push_back({ name, start, end - start });
+        }
+    }
+
+    class Scope
+    {
+    public:
+        Scope(std::string_view name)
+            : m_name(name)
+        {
+            if (enabled())
+            {
+                m_start = clock::now();
+            }
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope()
+        {
+            if (m_start != clock::time_point{})
+            {
+                detail::local().events.push_back({ m_name, m_start, clock::now() - m_start });
+            }
+        }
+
+    private:
+        std::string_view m_name;
+        clock::time_point m_start{};
+    };
+
+    // Writes every recorded event, the threads that recorded them must have finished or be idle
+    bool export_to(const std::filesystem::path &path);
+} // namespace trace
+} // namespace ft
+
+#define FT_TRACE_CONCAT_IMPL(a, b) a##b
+#define FT_TRACE_CONCAT(a, b) FT_TRACE_CONCAT_IMPL(a, b)
+#define FT_TRACE_SCOPE(name) ::ft::trace::Scope FT_TRACE_CONCAT(ft_trace_scope_, __LINE__){ name }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+static void BM_to_string(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::string text = std::to_string(state.iterations());
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_to_string);
@@ -0,0 +1,14 @@
+#include <benchmark/benchmark.h>
+
+#include <format>
+#include <string>
+
+static void BM_format(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::string text = std::format("{}", state.iterations());
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_format);
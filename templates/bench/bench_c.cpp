@@ -0,0 +1,15 @@
+#include <benchmark/benchmark.h>
+
+#include <stdio.h>
+
+static void BM_snprintf(benchmark::State &state)
+{
+    char buffer[32];
+    for (auto _ : state)
+    {
+        int written = snprintf(buffer, sizeof(buffer), "%d", static_cast<int>(state.iterations()));
+        benchmark::DoNotOptimize(written);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_snprintf);
@@ -0,0 +1,9 @@
+#ifdef USE_IMPORT_STD
+import std;
+#else
+#include <print>
+#endif
+int main()
+{
+    std::println("Hello World");
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Profiling zones, compiled out unless the project is configured with -DENABLE_PROFILING=ON.
+// With -DENABLE_TRACY=ON as well, zones are sent to the Tracy profiler. Otherwise use a sampling profiler such as
+// perf, which relies on the frame pointers and debug info that ENABLE_PROFILING turns on.
+//
+//     void update()
+//     {
+//         PROFILE_ZONE();
+//         ...
+//     }
+#if defined(ENABLE_PROFILING) && defined(PROFILE_WITH_TRACY)
+#include <tracy/Tracy.hpp>
+#define PROFILE_ZONE() ZoneScoped
+#define PROFILE_ZONE_NAMED(name) ZoneScopedN(name)
+#define PROFILE_FRAME() FrameMark
+#else
+#define PROFILE_ZONE()
+#define PROFILE_ZONE_NAMED(name)
+#define PROFILE_FRAME()
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+/* Profiling zones, compiled out unless the project is configured with -DENABLE_PROFILING=ON.
+ * With -DENABLE_TRACY=ON as well, zones are sent to the Tracy profiler. Otherwise use a sampling profiler such as
+ * perf, which relies on the frame pointers and debug info that ENABLE_PROFILING turns on.
+ *
+ *     void update(void)
+ *     {
+ *         PROFILE_ZONE_BEGIN(zone);
+ *         ...
+ *         PROFILE_ZONE_END(zone);
+ *     }
+ */
+#if defined(ENABLE_PROFILING) && defined(PROFILE_WITH_TRACY)
+#include <tracy/TracyC.h>
+#define PROFILE_ZONE_BEGIN(ctx) TracyCZone(ctx, 1)
+#define PROFILE_ZONE_BEGIN_NAMED(ctx, name) TracyCZoneN(ctx, name, 1)
+#define PROFILE_ZONE_END(ctx) TracyCZoneEnd(ctx)
+#define PROFILE_FRAME() TracyCFrameMark
+#else
+#define PROFILE_ZONE_BEGIN(ctx)
+#define PROFILE_ZONE_BEGIN_NAMED(ctx, name)
+#define PROFILE_ZONE_END(ctx)
+#define PROFILE_FRAME()
+#endif